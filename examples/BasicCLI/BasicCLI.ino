@@ -103,16 +103,27 @@ void cmd_gr_handler(ArduinoCLI* cli, int argc, char *argv[]) {
     serial.println(F("Grrrr.....!"));
 }
 
+void cmd_count_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; // Unused
+    (void)argv; // Unused
+    Stream& serial = cli->getSerial();
+    /* Runs until Ctrl+C is pressed */
+    for (unsigned long n = 0; !cli->checkpoint(); n++) {
+        serial.println(n);
+    }
+}
+
 
 /* --- Command Table --- */
 CLI_Command_t commands[] = {
-    {"help", cmd_help_handler, 0, "Show this help message"},
-    {"gr", cmd_gr_handler, 0, "Prints Grrrr.....!"},
-    {"greet", cmd_greet_handler, 1, "Greets the user or a specific name"},
-    {"add", cmd_add_handler, CLI_DEFAULT_MAX_ARGS-1, "Adds numbers together"},
-    {"pin", cmd_pin_handler, 2, "Set digital pin to 0 or 1"},
-    {"exit", cmd_exit_handler, 0, "Stop CLI processing"},
-    {"quit", cmd_exit_handler, 0, "Alias for exit"},
+    {"help", cmd_help_handler, 0, "Show this help message", 0, NULL},
+    {"gr", cmd_gr_handler, 0, "Prints Grrrr.....!", 0, NULL},
+    {"greet", cmd_greet_handler, 1, "Greets the user or a specific name", 0, NULL},
+    {"add", cmd_add_handler, CLI_DEFAULT_MAX_ARGS-1, "Adds numbers together", 0, NULL},
+    {"pin", cmd_pin_handler, 2, "Set digital pin to 0 or 1", 0, NULL},
+    {"count", cmd_count_handler, 0, "Count up until Ctrl+C", 0, NULL},
+    {"exit", cmd_exit_handler, 0, "Stop CLI processing", 0, NULL},
+    {"quit", cmd_exit_handler, 0, "Alias for exit", 0, NULL},
 };
 const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
 
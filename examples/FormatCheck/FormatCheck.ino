@@ -0,0 +1,100 @@
+#include <ArduinoCLI.h>
+
+/*
+ * Checks the JSON and CBOR output of a handler that is cancelled midway through
+ * its document: the open objects and arrays must be closed before the error
+ * document, so a host can still parse both. Prints PASS or FAIL for each case.
+ */
+
+/* --- In-memory stream capturing the output --- */
+
+class CaptureStream final : public Stream {
+public:
+    CaptureStream() : _len(0) {}
+
+    void clear() { _len = 0; }
+
+    /* True if the output ends with the expected bytes */
+    bool endsWith(const uint8_t* expected, size_t len) const {
+        return _len >= len && memcmp(_buf + _len - len, expected, len) == 0;
+    }
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t c) override {
+        if (_len == sizeof(_buf)) return 0;
+        _buf[_len++] = c;
+        return 1;
+    }
+    using Print::write;
+
+private:
+    uint8_t _buf[128];
+    size_t _len;
+};
+
+/* --- Command Handler Functions --- */
+
+/* Starts {"a":[1,2,... (an array of 5 in CBOR) and is cancelled before finishing it */
+void cmd_array_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+    if (cli->isCborMode()) cli->cbor().beginObject(2).key(F("a")).beginArray(5).value(1).value(2);
+    else cli->json().beginObject().key(F("a")).beginArray().value(1).value(2);
+    cli->cancel();
+}
+
+/* Cancelled right after a member name */
+void cmd_key_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+    cli->json().beginObject().key(F("a"));
+    cli->cancel();
+}
+
+const CLI_Command_t commands[] = {
+    {"array", cmd_array_handler, 0, "Cancelled inside an array", 0, NULL},
+    {"key", cmd_key_handler, 0, "Cancelled after a key", 0, NULL},
+};
+const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+CaptureStream capture;
+ArduinoCLI cli(capture, commands, commandCount);
+
+static bool check(const __FlashStringHelper* name, const char* line, const uint8_t* expected, size_t len) {
+    char buf[16];
+    strncpy(buf, line, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    capture.clear();
+    cli.processInput(buf);
+    bool ok = capture.endsWith(expected, len);
+    Serial.print(name);
+    Serial.println(ok ? F(": PASS") : F(": FAIL"));
+    return ok;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) { ; }
+  cli.start();
+
+  static const char jsonArray[] = "{\"a\":[1,2]}\r\n{\"error\":\"cancelled\"}\r\n";
+  static const char jsonKey[] = "{\"a\":null}\r\n{\"error\":\"cancelled\"}\r\n";
+  /* {"a": [1, 2, null, null, null], null: null} {"error": "cancelled"} */
+  static const uint8_t cborArray[] = {
+      0xA2, 0x61, 'a', 0x85, 0x01, 0x02, 0xF6, 0xF6, 0xF6, 0xF6, 0xF6,
+      0xA1, 0x65, 'e', 'r', 'r', 'o', 'r', 0x69, 'c', 'a', 'n', 'c', 'e', 'l', 'l', 'e', 'd'
+  };
+
+  bool ok = true;
+  cli.setJsonMode(true);
+  ok &= check(F("JSON array"), "array", (const uint8_t*)jsonArray, strlen(jsonArray));
+  ok &= check(F("JSON key"), "key", (const uint8_t*)jsonKey, strlen(jsonKey));
+  cli.setCborMode(true);
+  ok &= check(F("CBOR array"), "array", cborArray, sizeof(cborArray));
+  Serial.println(ok ? F("PASS") : F("FAIL"));
+}
+
+void loop() {
+}
@@ -0,0 +1,133 @@
+#include <ArduinoCLI.h>
+#include <CLIHostServer.h>
+
+/*
+ * Scaling benchmark for the multithreaded host dispatcher.
+ * Runs a CPU-bound, thread-safe command from many closed-loop TCP clients with
+ * 1, 2, 4 ... N worker threads and reports commands/sec for each.
+ * Requires a Linux host build (e.g., EpoxyDuino).
+ */
+#ifndef CLI_HOST_SERVER
+#error "This example requires a Linux host build (e.g., EpoxyDuino)."
+#endif
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#define BENCH_PORT 2324
+#define BENCH_CLIENTS 64
+#define BENCH_SECONDS 2
+#define BENCH_WORK "work 200000"
+
+/* --- Command Handler Functions --- */
+
+/* CPU-bound: iterate a hash so the handler dominates the I/O cost */
+void cmd_work_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    unsigned long rounds = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000;
+    uint32_t h = 2166136261u;
+    for (unsigned long i = 0; i < rounds; i++) {
+        h = (h ^ (uint32_t)i) * 16777619u;
+    }
+    cli->getSerial().println(h, HEX);
+}
+
+
+/* --- Command Table --- */
+const CLI_Command_t commands[] = {
+    {"work", cmd_work_handler, 1, "Burn CPU for N rounds", CLI_FLAG_THREAD_SAFE, NULL},
+};
+const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+
+/* Closed-loop clients: send the command each time the prompt comes back */
+static void runClients(std::atomic<unsigned long>* completed, std::atomic<bool>* done) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(BENCH_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    static const char line[] = BENCH_WORK "\r\n";
+    int ep = epoll_create1(0);
+    int fds[BENCH_CLIENTS];
+    char last[BENCH_CLIENTS];   /* Last byte received, as the prompt may be split across reads */
+    for (int i = 0; i < BENCH_CLIENTS; i++) {
+        fds[i] = socket(AF_INET, SOCK_STREAM, 0);
+        connect(fds[i], (struct sockaddr*)&addr, sizeof(addr));
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = (uint32_t)i;
+        epoll_ctl(ep, EPOLL_CTL_ADD, fds[i], &ev);
+        last[i] = 0;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(BENCH_SECONDS);
+    struct epoll_event events[BENCH_CLIENTS];
+    char buf[4096];
+    while (std::chrono::steady_clock::now() < deadline) {
+        int n = epoll_wait(ep, events, BENCH_CLIENTS, 100);
+        for (int e = 0; e < n; e++) {
+            uint32_t i = events[e].data.u32;
+            ssize_t r = recv(fds[i], buf, sizeof(buf), 0);
+            if (r <= 0) continue;
+            /* Every response ends with the "> " prompt */
+            char before = (r >= 2) ? buf[r - 2] : last[i];
+            last[i] = buf[r - 1];
+            if (before == '>' && buf[r - 1] == ' ') {
+                (*completed)++;
+                send(fds[i], line, sizeof(line) - 1, MSG_NOSIGNAL);
+            }
+        }
+    }
+    for (int i = 0; i < BENCH_CLIENTS; i++) close(fds[i]);
+    close(ep);
+    *done = true;
+}
+
+static void runBenchmark(size_t threads) {
+    CLIHostServer server(commands, commandCount, BENCH_CLIENTS);
+    server.setWorkerThreads(threads);
+    if (!server.begin(BENCH_PORT)) {
+        Serial.println(F("Error: cannot listen."));
+        return;
+    }
+
+    std::atomic<unsigned long> completed(0);
+    std::atomic<bool> done(false);
+    std::thread clients(runClients, &completed, &done);
+    while (!done) {
+        server.poll(1);
+    }
+    clients.join();
+    server.end();
+
+    /* The first prompt of each client is not a completed command */
+    unsigned long commandsRun = completed > BENCH_CLIENTS ? completed - BENCH_CLIENTS : 0;
+    Serial.print(F("workers: "));
+    Serial.print((unsigned long)threads);
+    Serial.print(F("  commands/sec: "));
+    Serial.println(commandsRun / BENCH_SECONDS);
+}
+
+
+void setup() {
+  Serial.begin(115200);
+  size_t cores = std::thread::hardware_concurrency();
+  if (cores == 0) cores = 1;
+
+  Serial.println(F("--- Host dispatcher scaling ---"));
+  for (size_t threads = 1; threads < cores; threads *= 2) {
+      runBenchmark(threads);
+  }
+  runBenchmark(cores);
+  exit(0);
+}
+
+void loop() {
+}
@@ -0,0 +1,71 @@
+#include <ArduinoCLI.h>
+#include <CLIHostServer.h>
+
+/*
+ * Serves the command set over TCP on a Linux host build (e.g., EpoxyDuino).
+ * Connect with:  telnet 127.0.0.1 2323
+ * Load test with extras/host/cli_loadgen.
+ */
+#ifndef CLI_HOST_SERVER
+#error "This example requires a Linux host build (e.g., EpoxyDuino)."
+#endif
+
+/* --- Command Handler Functions --- */
+
+void cmd_help_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+    cli->printHelp();
+}
+
+void cmd_echo_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    Stream& serial = cli->getSerial();
+    for (int i = 1; i < argc; i++) {
+        if (i > 1) serial.print(' ');
+        serial.print(argv[i]);
+    }
+    serial.println();
+}
+
+void cmd_add_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    long sum = 0;
+    for (int i = 1; i < argc; i++) {
+        sum += strtol(argv[i], NULL, 10);
+    }
+    cli->getSerial().println(sum);
+}
+
+void cmd_exit_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+    cli->getSerial().println(F("Bye."));
+    cli->stop(); /* Server closes the connection */
+}
+
+
+/* --- Command Table --- */
+const CLI_Command_t commands[] = {
+    {"help", cmd_help_handler, 0, "Show this help message", 0, NULL},
+    {"echo", cmd_echo_handler, CLI_DEFAULT_MAX_ARGS, "Print the arguments", 0, NULL},
+    {"add", cmd_add_handler, CLI_DEFAULT_MAX_ARGS, "Adds numbers together", 0, NULL},
+    {"exit", cmd_exit_handler, 0, "Close this connection", 0, NULL},
+};
+const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+
+/* --- Server: up to 4096 sessions sharing one command table --- */
+CLIHostServer server(commands, commandCount);
+
+
+void setup() {
+  Serial.begin(115200);
+  if (!server.begin(2323)) {
+      Serial.println(F("Error: cannot listen on port 2323."));
+      exit(1);
+  }
+  Serial.println(F("Listening on 127.0.0.1:2323"));
+}
+
+void loop() {
+  server.poll(10);
+}
@@ -0,0 +1,58 @@
+#include <ArduinoCLI.h>
+#include <CLISessionManager.h>
+
+/*
+ * Serves one command set on two serial ports at once.
+ * Requires a board with a second hardware serial port (Serial1).
+ */
+
+/* --- Command Handler Functions --- */
+
+void cmd_help_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+    cli->printHelp();
+}
+
+void cmd_uptime_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+    Stream& serial = cli->getSerial(); /* The port this command was typed on */
+    serial.print(F("Uptime: "));
+    serial.print(millis() / 1000);
+    serial.println(F(" s"));
+}
+
+void cmd_exit_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+    cli->getSerial().println(F("Session closed."));
+    cli->stop(); /* The manager returns the session to its pool */
+}
+
+
+/* --- Command Table --- */
+const CLI_Command_t commands[] = {
+    {"help", cmd_help_handler, 0, "Show this help message", 0, NULL},
+    {"uptime", cmd_uptime_handler, 0, "Seconds since reset", 0, NULL},
+    {"exit", cmd_exit_handler, 0, "Close this session", 0, NULL},
+};
+const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+
+/* --- Session Manager: 2 sessions sharing one command table --- */
+CLISessionManager<2> sessions(commands, commandCount);
+
+
+void setup() {
+  Serial.begin(115200);
+  Serial1.begin(115200);
+
+  sessions.attach(Serial, "usb> ");
+  sessions.attach(Serial1, "uart> ");
+}
+
+void loop() {
+  /* One call services both ports, round-robin */
+  sessions.poll();
+}
@@ -0,0 +1,79 @@
+#include <ArduinoCLI.h>
+
+/*
+ * Compares processInput() (tokenize + lookup on every call) with prepare()/execute()
+ * (tokenize + lookup once) for the same command line.
+ * Command output goes to a discarding stream so only the dispatch cost is measured.
+ */
+
+#define ITERATIONS 2000
+
+volatile long result; /* Keeps the handler from being optimized away */
+
+/* --- Command Handler Functions --- */
+
+void cmd_add_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)cli;  /* Unused */
+    (void)argc; /* Unused */
+    result = atol(argv[1]) + atol(argv[2]);
+}
+
+void cmd_noop_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)cli;  /* Unused */
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+}
+
+
+/* --- Command Table (a few entries so the lookup has work to do) --- */
+const CLI_Command_t commands[] = {
+    {"help", cmd_noop_handler, 0, "Show this help message", 0, NULL},
+    {"add", cmd_add_handler, 2, "Add two numbers", 0, NULL},
+    {"adc", cmd_noop_handler, 1, "Read analog pin", 0, NULL},
+    {"led", cmd_noop_handler, 1, "Set LED", 0, NULL},
+    {"reset", cmd_noop_handler, 0, "Reset", 0, NULL},
+    {"status", cmd_noop_handler, 0, "Show status", 0, NULL},
+};
+const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+
+CLIPrintStream nullStream(nullptr); /* Discards output */
+ArduinoCLI cli(nullStream, commands, commandCount);
+
+const char* benchLine = "add 1234 5678";
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) { ; }
+  cli.start();
+
+  /* processInput() needs a mutable copy each time, as the line is tokenized in place */
+  char line[CLI_DEFAULT_MAX_LINE_LEN];
+  unsigned long start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    strcpy(line, benchLine);
+    cli.processInput(line);
+  }
+  unsigned long parsed = micros() - start;
+
+  CLIPreparedCommand prepared;
+  if (cli.prepare(benchLine, &prepared) != CLI_PREPARE_OK) {
+    Serial.println(F("prepare() failed"));
+    return;
+  }
+  start = micros();
+  for (int i = 0; i < ITERATIONS; i++) {
+    cli.execute(&prepared);
+  }
+  unsigned long direct = micros() - start;
+
+  Serial.print(F("processInput(): "));
+  Serial.print((float)parsed / ITERATIONS);
+  Serial.println(F(" us/command"));
+  Serial.print(F("execute():      "));
+  Serial.print((float)direct / ITERATIONS);
+  Serial.println(F(" us/command"));
+}
+
+void loop() {
+}
@@ -0,0 +1,62 @@
+#include <ArduinoCLI.h>
+#include <CLITask.h>
+
+/*
+ * Runs the CLI in its own task instead of loop().
+ * The task sleeps until the UART receive callback (ESP32) notifies it, and long
+ * commands run in a separate lower-priority task.
+ * Builds on ESP32, on other boards with CLI_OS_FREERTOS defined, and on Linux hosts.
+ */
+#ifndef CLI_OS_AVAILABLE
+#error "This example needs FreeRTOS (ESP32, or define CLI_OS_FREERTOS) or a Linux host"
+#endif
+
+/* --- Command Handler Functions --- */
+
+void cmd_help_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+    cli->printHelp();
+}
+
+void cmd_count_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    Stream& serial = cli->getSerial();
+    long n = (argc > 1) ? atol(argv[1]) : 10;
+    for (long i = 1; i <= n; i++) {
+        if (cli->checkpoint()) return; /* Ctrl+C */
+        serial.println(i);
+        delay(200); /* Blocks only the command task */
+    }
+}
+
+
+/* --- Command Table --- */
+const CLI_Command_t commands[] = {
+    {"help", cmd_help_handler, 0, "Show this help message", 0, NULL},
+    {"count", cmd_count_handler, 1, "Count slowly (Ctrl+C stops)", 0, NULL},
+};
+const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+
+/* --- CLI Instance and Task --- */
+ArduinoCLI cli(Serial, commands, commandCount);
+CLITask cliTask(cli);
+
+
+void setup() {
+  Serial.begin(115200);
+
+#if defined(ARDUINO_ARCH_ESP32)
+  /* Wake the CLI task only when bytes arrive */
+  Serial.onReceive([]() { cliTask.notify(); });
+  cliTask.setIdleTimeout(CLI_OS_WAIT_FOREVER);
+#endif
+
+  cliTask.setCommandTask(CLI_TASK_DEFAULT_PRIORITY);   /* Handlers below console I/O */
+  cliTask.begin(CLI_TASK_DEFAULT_PRIORITY + 1);
+}
+
+void loop() {
+  /* Free for application work; the CLI no longer needs polling here */
+  delay(1000);
+}
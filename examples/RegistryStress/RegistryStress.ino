@@ -0,0 +1,125 @@
+#include <ArduinoCLI.h>
+#include <CLICommandRegistry.h>
+
+/*
+ * Stress test for CLICommandRegistry: concurrent lookups during churn.
+ * One writer thread adds and removes commands as fast as it can while N reader
+ * threads look commands up through their own reader slots. Every lookup checks that
+ * the snapshot it sees is consistent; build with -fsanitize=address (or thread) to
+ * also catch a snapshot freed while still in use.
+ * Requires a Linux host build (e.g., EpoxyDuino).
+ */
+#ifndef __linux__
+#error "This example requires a Linux host build (e.g., EpoxyDuino)."
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#define STRESS_SECONDS 3
+#define STRESS_READERS 4
+#define STRESS_CHURN 16     /* Commands added and removed by the writer */
+
+/* --- Command Handler Functions --- */
+
+void cmd_status_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+    cli->getSerial().println(F("OK"));
+}
+
+void cmd_churn_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    cli->getSerial().println(argv[0]);
+}
+
+
+/* --- Command Table --- */
+const CLI_Command_t commands[] = {
+    {"status", cmd_status_handler, 0, "Always present", 0, NULL},
+};
+const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+/* Churn commands carry their own name as ctx, so a reader can tell a torn entry;
+ * "tmp00" .. "tmp15": no name is a prefix of another */
+static char churnNames[STRESS_CHURN][8];
+static CLI_Command_t churn[STRESS_CHURN];
+
+CLICommandRegistry registry(commands, commandCount, STRESS_READERS);
+
+static std::atomic<bool> running(true);
+static std::atomic<unsigned long> lookups(0);
+static std::atomic<unsigned long> errors(0);
+
+
+/* Reader: acquire, check the snapshot, release */
+static void runReader(unsigned seed) {
+    int slot = registry.registerReader();
+    if (slot < 0) {
+        errors++;
+        return;
+    }
+    unsigned long n = 0;
+    while (running) {
+        const CLICommandTable* table = registry.acquire(slot);
+        const CLI_Command_t* cmd = table ? table->find("status") : nullptr;
+        if (!cmd || cmd->func != cmd_status_handler) errors++;
+
+        seed = seed * 1103515245u + 12345u;
+        const char* name = churnNames[(seed >> 16) % STRESS_CHURN];
+        cmd = table ? table->find(name) : nullptr;
+        if (cmd && (strcmp(cmd->name, name) != 0 || cmd->ctx != (const void*)cmd->name)) errors++;
+
+        for (size_t i = 0; table && i < table->count(); i++) {
+            if (table->command(i)->name == nullptr) errors++;
+        }
+        registry.release(slot);
+        n++;
+    }
+    lookups += n;
+    registry.unregisterReader(slot);
+}
+
+
+void setup() {
+  Serial.begin(115200);
+  for (size_t i = 0; i < STRESS_CHURN; i++) {
+      snprintf(churnNames[i], sizeof(churnNames[i]), "tmp%02u", (unsigned)i);
+      churn[i] = {churnNames[i], cmd_churn_handler, 0, "Churned", 0, churnNames[i]};
+  }
+
+  Serial.println(F("--- Registry lookups during churn ---"));
+  std::thread readers[STRESS_READERS];
+  for (size_t i = 0; i < STRESS_READERS; i++) {
+      readers[i] = std::thread(runReader, (unsigned)i + 1);
+  }
+
+  /* Writer: every round adds one churn command and removes another */
+  unsigned long publishes = 0;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(STRESS_SECONDS);
+  for (size_t i = 0; std::chrono::steady_clock::now() < deadline; i = (i + 1) % STRESS_CHURN) {
+      if (registry.add(churn[i])) publishes++;
+      if (registry.remove(churnNames[(i + STRESS_CHURN / 2) % STRESS_CHURN])) publishes++;
+  }
+  running = false;
+  for (size_t i = 0; i < STRESS_READERS; i++) {
+      readers[i].join();
+  }
+
+  /* With every reader gone, nothing may stay retired */
+  size_t pending = registry.reclaim();
+  if (pending != 0) errors++;
+
+  Serial.print(F("publishes: "));
+  Serial.print(publishes);
+  Serial.print(F("  lookups: "));
+  Serial.print(lookups.load());
+  Serial.print(F("  errors: "));
+  Serial.println(errors.load());
+  Serial.println(errors == 0 ? F("PASS") : F("FAIL"));
+  exit(errors == 0 ? 0 : 1);
+}
+
+void loop() {
+}
@@ -0,0 +1,88 @@
+#include <ArduinoCLI.h>
+#include <ArduinoCLIT.h>
+
+/*
+ * Compares the per-byte input cost of ArduinoCLI (virtual Stream calls) with
+ * ArduinoCLIT<StreamT> (direct calls to the concrete stream type).
+ * Both sessions read the same command lines from an in-memory stream that discards
+ * its output, so only the line discipline and the stream calls are measured.
+ */
+
+#define ITERATIONS 200
+
+/* --- In-memory stream replaying a fixed text --- */
+
+class ReplayStream final : public Stream {
+public:
+    explicit ReplayStream(const char* text) : _text(text), _pos(0), _len(strlen(text)) {}
+
+    void rewind() { _pos = 0; }
+
+    int available() override { return (int)(_len - _pos); }
+    int read() override { return (_pos < _len) ? (uint8_t)_text[_pos++] : -1; }
+    int peek() override { return (_pos < _len) ? (uint8_t)_text[_pos] : -1; }
+    size_t write(uint8_t c) override { (void)c; return 1; } /* Discard echo and output */
+    using Print::write;
+
+private:
+    const char* _text;
+    size_t _pos;
+    size_t _len;
+};
+
+/* --- Command Handler Functions --- */
+
+void cmd_noop_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)cli;  /* Unused */
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+}
+
+const CLI_Command_t commands[] = {
+    {"set", cmd_noop_handler, 8, "Set a value", 0, NULL},
+    {"status", cmd_noop_handler, 0, "Show status", 0, NULL},
+};
+const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+/* Long lines, so per-byte work dominates the per-command work */
+const char* script =
+    "set alpha 123456 beta 654321 gamma 111111 delta 222222\r\n"
+    "set epsilon 0x1234 zeta 0x5678 eta 0x9abc theta 0xdef0\r\n"
+    "status\r\n";
+
+ReplayStream virtualInput(script);
+ReplayStream directInput(script);
+ArduinoCLI virtualCli(virtualInput, commands, commandCount);
+ArduinoCLIT<ReplayStream> directCli(directInput, commands, commandCount);
+
+/* Feeds the script ITERATIONS times; returns microseconds */
+template <class CLI>
+unsigned long run(CLI& cli, ReplayStream& input) {
+    unsigned long start = micros();
+    for (int i = 0; i < ITERATIONS; i++) {
+        input.rewind();
+        cli.poll();
+    }
+    return micros() - start;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) { ; }
+  virtualCli.start();
+  directCli.start();
+
+  unsigned long bytes = (unsigned long)strlen(script) * ITERATIONS;
+  unsigned long virtualUs = run(virtualCli, virtualInput);
+  unsigned long directUs = run(directCli, directInput);
+
+  Serial.print(F("ArduinoCLI (Stream&):      "));
+  Serial.print((float)virtualUs * 1000.0 / bytes);
+  Serial.println(F(" ns/byte"));
+  Serial.print(F("ArduinoCLIT<ReplayStream>: "));
+  Serial.print((float)directUs * 1000.0 / bytes);
+  Serial.println(F(" ns/byte"));
+}
+
+void loop() {
+}
@@ -0,0 +1,177 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Load generator for the host TCP front-end (CLIHostServer).            *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file cli_loadgen.cpp
+ * \brief Opens many closed-loop TCP sessions against CLIHostServer and reports
+ *        commands/sec and latency percentiles.
+ *
+ * Standalone Linux tool, not part of the Arduino library build:
+ *
+ *     g++ -O2 -std=c++11 -o cli_loadgen cli_loadgen.cpp
+ *     ./cli_loadgen -c 2000 -d 10 -p 2323 "add 1 2"
+ *
+ * Each connection waits for the prompt, sends the command line, and measures the
+ * time until the next prompt arrives.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+typedef std::chrono::steady_clock Clock;
+
+struct Session {
+    int fd;
+    bool ready;                 /* Initial prompt seen */
+    std::string tail;           /* Last bytes received, for prompt detection */
+    Clock::time_point sentAt;   /* When the outstanding command was sent */
+};
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s [-a addr] [-p port] [-c connections] [-d seconds] [-P prompt] [command]\n"
+            "Defaults: -a 127.0.0.1 -p 2323 -c 1000 -d 10 -P \"> \" \"help\"\n", argv0);
+}
+
+static bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    const char* addrStr = "127.0.0.1";
+    int port = 2323;
+    int connections = 1000;
+    int seconds = 10;
+    std::string prompt = "> ";
+    std::string command = "help";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "a:p:c:d:P:h")) != -1) {
+        switch (opt) {
+        case 'a': addrStr = optarg; break;
+        case 'p': port = atoi(optarg); break;
+        case 'c': connections = atoi(optarg); break;
+        case 'd': seconds = atoi(optarg); break;
+        case 'P': prompt = optarg; break;
+        default: usage(argv[0]); return 2;
+        }
+    }
+    if (optind < argc) command = argv[optind];
+    command += "\r\n";
+    if (connections <= 0 || seconds <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    /* Thousands of sockets need a raised descriptor limit */
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < (rlim_t)connections + 64) {
+        rl.rlim_cur = std::min<rlim_t>(rl.rlim_max, (rlim_t)connections + 64);
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, addrStr, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Bad address '%s'\n", addrStr);
+        return 2;
+    }
+
+    int ep = epoll_create1(0);
+    std::vector<Session> sessions(connections);
+    for (int i = 0; i < connections; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            fprintf(stderr, "Connection %d failed: %s\n", i, strerror(errno));
+            return 1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        sessions[i].fd = fd;
+        sessions[i].ready = false;
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = (uint32_t)i;
+        epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    std::vector<uint32_t> latencies;
+    latencies.reserve(1 << 20);
+    std::vector<struct epoll_event> events(1024);
+    char buf[8192];
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::seconds(seconds);
+    while (Clock::now() < deadline) {
+        int n = epoll_wait(ep, events.data(), (int)events.size(), 100);
+        for (int e = 0; e < n; e++) {
+            Session& s = sessions[events[e].data.u32];
+            ssize_t r = recv(s.fd, buf, sizeof(buf), 0);
+            if (r <= 0) {
+                fprintf(stderr, "Connection closed by server\n");
+                return 1;
+            }
+            s.tail.append(buf, (size_t)r);
+            if (s.tail.size() > 256) s.tail.erase(0, s.tail.size() - 256);
+            if (!endsWith(s.tail, prompt)) continue; /* Response not complete yet */
+
+            Clock::time_point now = Clock::now();
+            if (s.ready) {
+                latencies.push_back((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - s.sentAt).count());
+            }
+            s.ready = true;
+            s.tail.clear();
+            s.sentAt = now;
+            if (send(s.fd, command.data(), command.size(), MSG_NOSIGNAL) < 0) {
+                fprintf(stderr, "Send failed: %s\n", strerror(errno));
+                return 1;
+            }
+        }
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (size_t i = 0; i < sessions.size(); i++) close(sessions[i].fd);
+    close(ep);
+
+    if (latencies.empty()) {
+        printf("No commands completed.\n");
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    size_t count = latencies.size();
+    printf("connections:   %d\n", connections);
+    printf("commands:      %zu in %.2f s\n", count, elapsed);
+    printf("commands/sec:  %.0f\n", count / elapsed);
+    printf("latency p50:   %u us\n", latencies[count / 2]);
+    printf("latency p99:   %u us\n", latencies[std::min(count - 1, count * 99 / 100)]);
+    printf("latency max:   %u us\n", latencies[count - 1]);
+    return 0;
+}
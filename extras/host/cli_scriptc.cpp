@@ -0,0 +1,227 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Host-side compiler for ArduinoCLI scripts.                            *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file cli_scriptc.cpp
+ * \brief Compiles a text script into the format run by ArduinoCLI::runScript().
+ *
+ * Standalone tool, not part of the Arduino library build:
+ *
+ *     g++ -O2 -std=c++11 -o cli_scriptc cli_scriptc.cpp
+ *     ./cli_scriptc -t commands.txt -o provision.cls provision.txt
+ *
+ * The table file describes the firmware's CLI_Command_t array, one "name max_args"
+ * entry per line in array order ('#' starts a comment). It must match the firmware
+ * exactly, as the compiled script carries a hash of it (see CLICommandTable::hash()).
+ */
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCRIPT_VERSION 1
+#define SCRIPT_MAX_ARGS 8           /* CLI_SCRIPT_MAX_ARGS of the firmware */
+#define SCRIPT_LINE_LEN 64          /* CLI_SCRIPT_LINE_LEN of the firmware */
+
+struct Command {
+    std::string name;
+    int maxArgs;
+};
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s -t table.txt [-o out.cls] [-m max_args] [-l line_len] script.txt\n"
+            "Defaults: -o script.cls -m %d -l %d\n", argv0, SCRIPT_MAX_ARGS, SCRIPT_LINE_LEN);
+}
+
+static bool readFile(const char* path, std::string* text) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        text->append(buf, n);
+    }
+    fclose(f);
+    return true;
+}
+
+/* Splits on the same delimiters as ArduinoCLI::_splitLine() */
+static std::vector<std::string> split(const std::string& line) {
+    std::vector<std::string> out;
+    const char* delims = " \t\r\n\a";
+    size_t pos = line.find_first_not_of(delims);
+    while (pos != std::string::npos) {
+        size_t end = line.find_first_of(delims, pos);
+        out.push_back(line.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+        pos = (end == std::string::npos) ? end : line.find_first_not_of(delims, end);
+    }
+    return out;
+}
+
+static std::vector<std::string> lines(const std::string& text) {
+    std::vector<std::string> out;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) end = text.size();
+        out.push_back(text.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    return out;
+}
+
+/* Same as CLICommandTable::hash() */
+static uint32_t tableHash(const std::vector<Command>& table) {
+    uint32_t h = 2166136261UL;
+    uint32_t count = (uint32_t)table.size();
+    for (int b = 0; b < 4; b++) {
+        h = (h ^ (uint8_t)(count >> (8 * b))) * 16777619UL;
+    }
+    for (const Command& c : table) {
+        for (size_t i = 0; i <= c.name.size(); i++) {
+            h = (h ^ (uint8_t)c.name.c_str()[i]) * 16777619UL;
+        }
+        h = (h ^ (uint8_t)c.maxArgs) * 16777619UL;
+    }
+    return h;
+}
+
+/* Same rules as CLICommandTable::find(): exact match wins, else a unique prefix */
+static int findCommand(const std::vector<Command>& table, const std::string& prefix, int* matches) {
+    int found = -1;
+    *matches = 0;
+    for (size_t i = 0; i < table.size(); i++) {
+        if (table[i].name == prefix) {
+            *matches = 1;
+            return (int)i;
+        }
+        if (table[i].name.compare(0, prefix.size(), prefix) == 0) {
+            if (found < 0) found = (int)i;
+            (*matches)++;
+        }
+    }
+    return (*matches == 1) ? found : -1;
+}
+
+int main(int argc, char** argv) {
+    const char* tablePath = nullptr;
+    const char* outPath = "script.cls";
+    int maxArgs = SCRIPT_MAX_ARGS;
+    size_t lineLen = SCRIPT_LINE_LEN;
+    int opt = 1;
+    for (; opt < argc && argv[opt][0] == '-'; opt++) {
+        if (opt + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        switch (argv[opt][1]) {
+            case 't': tablePath = argv[++opt]; break;
+            case 'o': outPath = argv[++opt]; break;
+            case 'm': maxArgs = atoi(argv[++opt]); break;
+            case 'l': lineLen = (size_t)atoi(argv[++opt]); break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (!tablePath || opt + 1 != argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string text;
+    if (!readFile(tablePath, &text)) return 1;
+    std::vector<Command> table;
+    for (const std::string& l : lines(text)) {
+        std::vector<std::string> f = split(l);
+        if (f.empty() || f[0][0] == '#') continue;
+        Command c;
+        c.name = f[0];
+        c.maxArgs = (f.size() > 1) ? atoi(f[1].c_str()) : 0;
+        table.push_back(c);
+    }
+
+    text.clear();
+    if (!readFile(argv[opt], &text)) return 1;
+
+    std::vector<uint8_t> out(10);
+    unsigned records = 0;
+    unsigned lineNo = 0;
+    for (const std::string& l : lines(text)) {
+        lineNo++;
+        std::vector<std::string> args = split(l);
+        if (args.empty() || args[0][0] == '#') continue;
+        if (l.find_first_of(";|") != std::string::npos || l.find("&&") != std::string::npos) {
+            fprintf(stderr, "%s:%u: Operators (; && || |) are not supported\n", argv[opt], lineNo);
+            return 1;
+        }
+
+        int matches;
+        int index = findCommand(table, args[0], &matches);
+        if (index < 0) {
+            fprintf(stderr, "%s:%u: %s command '%s'\n", argv[opt], lineNo,
+                    matches > 1 ? "Ambiguous" : "Unknown", args[0].c_str());
+            return 1;
+        }
+        int userArgs = (int)args.size() - 1;
+        if (userArgs > table[index].maxArgs || userArgs > maxArgs) {
+            fprintf(stderr, "%s:%u: Too many arguments for '%s'\n", argv[opt], lineNo, table[index].name.c_str());
+            return 1;
+        }
+        if (records == 0xFFFF) {
+            fprintf(stderr, "%s:%u: Too many commands\n", argv[opt], lineNo);
+            return 1;
+        }
+
+        out.push_back((uint8_t)index);
+        out.push_back((uint8_t)(index >> 8));
+        out.push_back((uint8_t)userArgs);
+        size_t bytes = 0; /* The firmware copies each record's arguments to a line_len buffer */
+        for (int i = 1; i <= userArgs; i++) {
+            bytes += args[i].size() + 1;
+            if (args[i].size() > 255 || bytes > lineLen) {
+                fprintf(stderr, "%s:%u: Argument too long\n", argv[opt], lineNo);
+                return 1;
+            }
+            out.push_back((uint8_t)args[i].size());
+            out.insert(out.end(), args[i].begin(), args[i].end());
+            out.push_back(0);
+        }
+        records++;
+    }
+
+    uint32_t h = tableHash(table);
+    out[0] = 'C';
+    out[1] = 'L';
+    out[2] = 'S';
+    out[3] = SCRIPT_VERSION;
+    for (int b = 0; b < 4; b++) {
+        out[4 + b] = (uint8_t)(h >> (8 * b));
+    }
+    out[8] = (uint8_t)records;
+    out[9] = (uint8_t)(records >> 8);
+
+    FILE* f = fopen(outPath, "wb");
+    if (!f || fwrite(out.data(), 1, out.size(), f) != out.size()) {
+        perror(outPath);
+        if (f) fclose(f);
+        return 1;
+    }
+    fclose(f);
+    printf("%s: %u commands, %zu bytes, table hash %08lx\n", outPath, records, out.size(), (unsigned long)h);
+    return 0;
+}
@@ -17,35 +17,353 @@
 + */
 
 #include "ArduinoCLI.h"
+#include "CLICommandRegistry.h"
+#include "CLIAtomic.h"
+#include "CLIScheduler.h"
+#include "CLIPipe.h"
+#include "ArduinoCLIT.h"
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
 
-/* Constructor */
-ArduinoCLI::ArduinoCLI(Stream& serialPort, const CLI_Command_t commands[], size_t commandCount) :
-    _serial(serialPort),
+/* Payload bytes sent between checks for pipelined input in machine mode */
+#define CLI_FRAME_CHUNK 16
+
+/* Operators between chained commands (_chainOp) */
+#define CLI_CHAIN_END 0             /* Last command of the line */
+#define CLI_CHAIN_ALWAYS 1          /* ';' */
+#define CLI_CHAIN_AND 2             /* '&&': run if the previous command succeeded */
+#define CLI_CHAIN_OR 3              /* '||': run if the previous command failed */
+#define CLI_CHAIN_PIPE 4            /* '|': the next command reads this one's output */
+
+/* --- Command Table and Lookup Index --- */
+
+CLICommandTable::CLICommandTable(const CLI_Command_t commands[], size_t commandCount, uint8_t* indexStorage) :
     _commands(commands),
-    _commandCount(commandCount),
+    _commandCount(commands ? commandCount : 0),
+    _index(nullptr),
+    _indexCount(0),
+    _ownsIndex(false)
+{
+    if (_commandCount == 0 || _commandCount > CLI_MAX_INDEXED_COMMANDS) return; /* Linear search */
+
+    _index = indexStorage;
+    if (!_index) {
+        _index = (uint8_t*)malloc(_commandCount);
+        if (!_index) return;
+        _ownsIndex = true;
+    }
+
+    /* Insertion sort of named entries; tables are small and built once */
+    for (size_t i = 0; i < _commandCount; i++) {
+        const char *name = _commands[i].name;
+        if (name == NULL) continue; /* Skip potentially null entries if any */
+        size_t j = _indexCount++;
+        while (j > 0 && strcmp(_commands[_index[j - 1]].name, name) > 0) {
+            _index[j] = _index[j - 1];
+            j--;
+        }
+        _index[j] = (uint8_t)i;
+    }
+}
+
+CLICommandTable::~CLICommandTable() {
+    if (_ownsIndex) free(_index);
+}
+
+size_t CLICommandTable::count() const {
+    return _commandCount;
+}
+
+const CLI_Command_t* CLICommandTable::command(size_t i) const {
+    return (i < _commandCount) ? &_commands[i] : NULL;
+}
+
+/* Binary search for the first sorted name >= prefix */
+size_t CLICommandTable::_lowerBound(const char* prefix) const {
+    size_t lo = 0, hi = _indexCount;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (strcmp(_commands[_index[mid]].name, prefix) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static bool cli_is_delim(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\a';
+}
+
+/* ';', '|' or a doubled '&' / '|' */
+static uint8_t cli_chain_op(const char* p) {
+    if (*p == ';') return CLI_CHAIN_ALWAYS;
+    if (*p == '&' && p[1] == '&') return CLI_CHAIN_AND;
+    if (*p == '|') return (p[1] == '|') ? CLI_CHAIN_OR : CLI_CHAIN_PIPE;
+    return CLI_CHAIN_END;
+}
+
+/*
+ * Tokenizer for chained lines: one pass, stops at the first operator
+ * Modifies the input string!
+ */
+int ArduinoCLI::_splitCommand(char **line, char **argv_local, size_t max_args_local, uint8_t *op) {
+    int argc = 0;
+    char *p = *line;
+
+    *op = CLI_CHAIN_END;
+    while (*p) {
+        uint8_t next = cli_chain_op(p);
+        if (next != CLI_CHAIN_END) {
+            *op = next;
+            *p = '\0';
+            p += (next == CLI_CHAIN_AND || next == CLI_CHAIN_OR) ? 2 : 1;
+            break;
+        }
+        if (cli_is_delim(*p)) {
+            *p++ = '\0';
+            continue;
+        }
+        /* Start of a token; extra tokens are dropped like _splitLine() does */
+        if ((size_t)argc < max_args_local - 1) argv_local[argc++] = p;
+        while (*p && !cli_is_delim(*p) && cli_chain_op(p) == CLI_CHAIN_END) p++;
+    }
+    argv_local[argc] = NULL; /* Null-terminate argv array */
+    *line = (*op == CLI_CHAIN_END) ? NULL : p;
+    return argc;
+}
+
+int ArduinoCLI::_splitSingle(char *line, char **argv_local, size_t max_args_local) {
+    uint8_t op;
+    int argc = _splitCommand(&line, argv_local, max_args_local, &op);
+    return (op == CLI_CHAIN_END) ? argc : -1;
+}
+
+
+/* Find command based on prefix */
+const CLI_Command_t* CLICommandTable::find(const char* prefix, int* matchCount) const {
+    const CLI_Command_t *found_cmd = NULL;
+    const CLI_Command_t *exact_match = NULL;
+    int match_count = 0;
+    size_t prefix_len = strlen(prefix);
+
+    if (matchCount) *matchCount = 0;
+    if (prefix_len == 0) return NULL;
+
+    if (_index) {
+        /* Names sharing the prefix are contiguous in the sorted index */
+        for (size_t pos = _lowerBound(prefix); pos < _indexCount; pos++) {
+            const CLI_Command_t *cmd = &_commands[_index[pos]];
+            if (strncmp(prefix, cmd->name, prefix_len) != 0) break;
+            if (match_count == 0) {
+                found_cmd = cmd;
+                if (cmd->name[prefix_len] == '\0') exact_match = cmd; /* Sorts first */
+            }
+            match_count++;
+        }
+    } else {
+        for (size_t i = 0; i < _commandCount; i++) {
+            if (_commands[i].name == NULL) continue; /* Skip potentially null entries if any */
+
+            /* Check for exact match */
+            if (strcmp(prefix, _commands[i].name) == 0) {
+                exact_match = &_commands[i];
+            }
+            /* Check for prefix match */
+            if (strncmp(prefix, _commands[i].name, prefix_len) == 0) {
+                if (found_cmd == NULL) {
+                    found_cmd = &_commands[i]; /* First potential match */
+                }
+                match_count++;
+            }
+        }
+    }
+
+    if (matchCount) *matchCount = match_count;
+
+    /* Preference rule: Exact match wins */
+    if (exact_match) {
+        return exact_match;
+    }
+
+    /* If no exact match, check prefix matches */
+    if (match_count == 1) {
+        return found_cmd; /* Unique prefix match */
+    }
+
+    return NULL; /* Ambiguous or not found */
+}
+
+/* Collect names starting with prefix (for tab completion) */
+int CLICommandTable::collectMatches(const char* prefix, const char* names[], int maxNames) const {
+    int match_count = 0;
+    size_t prefix_len = strlen(prefix);
+
+    if (_index) {
+        for (size_t pos = _lowerBound(prefix); pos < _indexCount && match_count < maxNames; pos++) {
+            const char *name = _commands[_index[pos]].name;
+            if (strncmp(prefix, name, prefix_len) != 0) break;
+            names[match_count++] = name;
+        }
+    } else {
+        for (size_t i = 0; i < _commandCount && match_count < maxNames; i++) {
+            if (_commands[i].name != NULL && strncmp(prefix, _commands[i].name, prefix_len) == 0) {
+                names[match_count++] = _commands[i].name;
+            }
+        }
+    }
+    return match_count;
+}
+
+/* FNV-1a over count, then each name (with terminator) and max_args, in array order */
+uint32_t CLICommandTable::hash() const {
+    uint32_t h = 2166136261UL;
+    for (uint8_t b = 0; b < 4; b++) {
+        h = (h ^ (uint8_t)((uint32_t)_commandCount >> (8 * b))) * 16777619UL;
+    }
+    for (size_t i = 0; i < _commandCount; i++) {
+        const char* name = _commands[i].name ? _commands[i].name : "";
+        do {
+            h = (h ^ (uint8_t)*name) * 16777619UL;
+        } while (*name++ != '\0');
+        h = (h ^ (uint8_t)_commands[i].max_args) * 16777619UL;
+    }
+    return h;
+}
+
+
+/* --- ArduinoCLI --- */
+
+/* Per-Stream state of a new session */
+CLISessionState::CLISessionState(Stream* serial) :
+    _serial(serial),
     _isRunning(false), /* Start in non-running state */
     _lineBuffer(nullptr),
     _maxLineLen(CLI_DEFAULT_MAX_LINE_LEN),
     _bufferPos(0),
     _argv(nullptr),
-    _maxArgs(CLI_DEFAULT_MAX_ARGS + 1)
+    _maxArgs(CLI_DEFAULT_MAX_ARGS + 1),
+    _skipChar(0)
 {
     strncpy(_prompt, CLI_DEFAULT_PROMPT, CLI_MAX_PROMPT_LEN - 1);
     _prompt[CLI_MAX_PROMPT_LEN - 1] = '\0';
+#ifndef CLI_NO_EDITING
+    _historyCursor = 0;
+    _historySeen = 0;
+    _escape = 0;
+    _searching = false;
+    _searchOff = 0;
+    _searchLen = 0;
+#endif
+}
+
+/* Common initialization */
+ArduinoCLI::ArduinoCLI(Stream* serialPort, const CLI_Command_t commands[], size_t commandCount) :
+    CLISessionState(serialPort),
+    _ownTable(commands, commandCount),
+    _table(&_ownTable),
+    _ownsBuffers(false),
+    _cancelled(false),
+    _checkpointInterval(CLI_DEFAULT_CHECKPOINT_INTERVAL),
+    _checkpointCountdown(CLI_DEFAULT_CHECKPOINT_INTERVAL),
+    _queue(nullptr),
+    _queueSize(0),
+    _queueHead(0),
+    _queueWrite(0),
+    _queuePartialLen(0),
+    _queueCommitted(0),
+    _queueConsumed(0),
+    _queueStreamPartial(false),
+    _dispatchHook(nullptr),
+    _dispatchCtx(nullptr),
+    _dispatchPending(false),
+    _pendingTerminator(0),
+    _inject(nullptr),
+    _injectMask(0),
+    _injectTail(0),
+    _injectHead(0),
+    _registry(nullptr),
+    _readerSlot(-1),
+    _tablePins(0),
+    _unpinnedTable(nullptr),
+    _scheduler(nullptr),
+    _chain(nullptr),
+    _chainOp(CLI_CHAIN_END),
+    _pipeBuffer(nullptr),
+    _pipeSize(0),
+    _status(CLI_STATUS_OK),
+    _command(nullptr),
+    _machineMode(false),
+    _result(CLI_RESULT_OK),
+    _frameSeq(0),
+    _responseBuffer(nullptr),
+    _responseSize(0),
+    _requestId(nullptr),
+    _binaryMode(false),
+    _binBuffer(nullptr),
+    _binSize(0),
+    _binLen(0),
+    _binCode(0xFF),
+    _binRemaining(0),
+    _binError(false),
+    _checksum(CLI_CHECKSUM_NONE),
+    _format(CLI_FORMAT_TEXT),
+    _json(serialPort),
+    _cbor(serialPort)
+{
+#ifndef CLI_NO_EDITING
+    _history = nullptr;
+    _historySize = 0;
+    _historyHead = 0;
+    _historyUsed = 0;
+    _historyAdds = 0;
+#endif
+}
+
+/* Constructor */
+ArduinoCLI::ArduinoCLI(Stream& serialPort, const CLI_Command_t commands[], size_t commandCount) :
+    ArduinoCLI(&serialPort, commands, commandCount)
+{
     _allocateBuffers();
     _resetBuffer();
     /* Prompt printed by start() */
 }
 
-/* Destructor - uncomment if dynamic allocation needs cleanup */
-/*
+/* Constructor sharing a prebuilt command table */
+ArduinoCLI::ArduinoCLI(Stream& serialPort, const CLICommandTable& table) :
+    ArduinoCLI(&serialPort, nullptr, 0)
+{
+    _table = &table;
+    _allocateBuffers();
+    _resetBuffer();
+}
+
+/* Shared instance of a CLISessionManager; sessions are loaded into it */
+ArduinoCLI::ArduinoCLI() :
+    ArduinoCLI(nullptr, nullptr, 0)
+{
+}
+
+void ArduinoCLI::_loadSession(const CLISessionState& session) {
+    static_cast<CLISessionState&>(*this) = session;
+#ifndef CLI_NO_EDITING
+    if (_historySeen != _historyAdds) {
+        /* Lines added by other sessions may have evicted the entry under the cursor */
+        _historyCursor = _historySize;
+        if (_searching) _endSearch();
+        _historySeen = _historyAdds;
+    }
+#endif
+}
+
+void ArduinoCLI::_saveSession(CLISessionState& session) const {
+    session = *this;
+}
+
+/* Destructor - pooled sessions (e.g., CLIHostServer) are destroyed */
 ArduinoCLI::~ArduinoCLI() {
+    setCommandRegistry(nullptr);
     _freeBuffers();
 }
-*/
 
 /* Configuration */
 void ArduinoCLI::setMaxLineLen(size_t len) {
@@ -65,15 +383,34 @@ void ArduinoCLI::setPrompt(const char* prompt) {
     }
 }
 
+void ArduinoCLI::setCheckpointInterval(uint16_t interval) {
+    if (interval > 0) {
+        _checkpointInterval = interval;
+        _checkpointCountdown = interval;
+    }
+}
+
+/* Use caller-provided buffers */
+void ArduinoCLI::setBuffers(char* lineBuffer, size_t lineLen, char** argv, size_t argvLen) {
+    if (!lineBuffer || lineLen < 2 || !argv || argvLen < 2) return;
+    _freeBuffers();
+    _lineBuffer = lineBuffer;
+    _maxLineLen = lineLen;
+    _argv = argv;
+    _maxArgs = argvLen;
+    _resetBuffer();
+}
+
 /* Allocate memory for buffers */
 bool ArduinoCLI::_allocateBuffers() {
     _freeBuffers(); /* Free existing if any */
     _lineBuffer = (char*)malloc(_maxLineLen * sizeof(char));
     _argv = (char**)malloc(_maxArgs * sizeof(char*));
+    _ownsBuffers = true;
 
     if (!_lineBuffer || !_argv) {
         /* Try printing error even if serial might not be ready */
-        if (&_serial) _serial.println(F("Error: CLI buffer allocation failed!"));
+        if (_serial) _serial->println(F("Error: CLI buffer allocation failed!"));
         _freeBuffers(); /* Ensure consistency */
         return false;
     }
@@ -82,6 +419,13 @@ bool ArduinoCLI::_allocateBuffers() {
 
 /* Free buffer memory */
 void ArduinoCLI::_freeBuffers() {
+    if (!_ownsBuffers) {
+        /* Caller-provided storage is just forgotten */
+        _lineBuffer = nullptr;
+        _argv = nullptr;
+        return;
+    }
+    _ownsBuffers = false;
     if (_lineBuffer) {
         free(_lineBuffer);
         _lineBuffer = nullptr;
@@ -99,22 +443,26 @@ void ArduinoCLI::_resetBuffer() {
         _lineBuffer[0] = '\0';
     }
     _bufferPos = 0;
+#ifndef CLI_NO_EDITING
+    _historyCursor = _historySize; /* A new line is not a recalled entry */
+    _escape = 0;
+    _searching = false;
+#endif
 }
 
 /* Print the prompt, preceded by CRLF */
 void ArduinoCLI::_printPrompt() {
-    _serial.print(F("\r\n"));
-    _serial.print(_prompt);
+    if (_machineMode || _binaryMode) return;
+    _serial->print(F("\r\n"));
+    _serial->print(_prompt);
 }
 
-/* Echo character (if needed) */
-void ArduinoCLI::_printChar(char c) {
-    _serial.write(c);
-}
 
 /* Start or restart CLI processing */
 void ArduinoCLI::start() {
     _isRunning = true;
+    _resetBuffer(); /* Drop any partial line from a previous run */
+    _dispatchPending = false;
     /* Print initial prompt */
     _printPrompt();
 }
@@ -124,6 +472,38 @@ void ArduinoCLI::stop() {
     _isRunning = false;
 }
 
+/* Back to the just-constructed state; caller storage is detached, not freed */
+void ArduinoCLI::resetSession() {
+    stop();
+    setLineQueue(nullptr, 0);
+    setHistoryBuffer(nullptr, 0);
+    setInjectQueue(nullptr, 0);
+    setScheduler(nullptr);
+    setDispatchHook(nullptr, nullptr);
+    setPipeBuffer(nullptr, 0);
+    setResponseBuffer(nullptr, 0); /* Leaves machine and binary mode */
+    setBinaryBuffer(nullptr, 0);
+    cancelDispatch();
+    _pendingTerminator = 0;
+    _cancelled = false;
+    _checkpointInterval = CLI_DEFAULT_CHECKPOINT_INTERVAL;
+    _checkpointCountdown = CLI_DEFAULT_CHECKPOINT_INTERVAL;
+    _skipChar = 0;
+    _chain = nullptr;
+    _chainOp = CLI_CHAIN_END;
+    _status = CLI_STATUS_OK;
+    _command = nullptr;
+    _result = CLI_RESULT_OK;
+    _frameSeq = 0;
+    _requestId = nullptr;
+    _checksum = CLI_CHECKSUM_NONE;
+    _format = CLI_FORMAT_TEXT;
+    _json.reset();
+    _cbor.reset();
+    setPrompt(CLI_DEFAULT_PROMPT);
+    _resetBuffer();
+}
+
 /* Check run status */
 bool ArduinoCLI::isRunning() const {
     return _isRunning;
@@ -131,74 +511,442 @@ bool ArduinoCLI::isRunning() const {
 
 /* Access Serial */
 Stream& ArduinoCLI::getSerial() {
-    return _serial;
+    return *_serial;
+}
+
+
+/* --- Cooperative Cancellation --- */
+
+/* Latch a pending Ctrl+C without consuming other typed-ahead input */
+bool ArduinoCLI::isCancelled() {
+    if (_queue) {
+        _drainToQueue(); /* Type-ahead is kept in the queue, Ctrl+C latches on the way */
+    } else if (!_cancelled && _serial->available() > 0 && _serial->peek() == CLI_CTRL_C) {
+        _serial->read(); /* Consume only the Ctrl+C itself */
+        _cancelled = true;
+    }
+    return _cancelled;
+}
+
+/* Rate-limited cancellation check for handler inner loops */
+bool ArduinoCLI::checkpoint() {
+    if (--_checkpointCountdown != 0) {
+        return _cancelled;
+    }
+    _checkpointCountdown = _checkpointInterval;
+    return isCancelled();
+}
+
+/* Request cancellation of the running command */
+void ArduinoCLI::cancel() {
+    _cancelled = true;
+}
+
+
+/* --- Type-Ahead Line Queue --- */
+
+/*
+ * Single-producer ring: the producer owns _queueWrite and the partial line and publishes
+ * whole lines through _queueCommitted; the consumer owns _queueHead and _queueConsumed.
+ * Indices and counters may be wider than the CPU word and the producer may run on another
+ * core, so they cross over through the CLIAtomic helpers.
+ */
+void ArduinoCLI::setLineQueue(char* arena, size_t size) {
+    _queue = (arena && size > 1) ? arena : nullptr;
+    _queueSize = _queue ? size : 0;
+    _queueHead = 0;
+    _queueWrite = 0;
+    _queuePartialLen = 0;
+    _queueCommitted = 0;
+    _queueConsumed = 0;
+    _queueStreamPartial = false;
+}
+
+size_t ArduinoCLI::queuedLines() const {
+    return cli_atomic_load(&_queueCommitted) - cli_atomic_load(&_queueConsumed);
+}
+
+/* Producer side: collect one byte into the partial line at the ring tail */
+bool ArduinoCLI::feedInput(char c) {
+    if (!_queue) return false;
+
+    if (_skipChar) {
+        char skip = _skipChar;
+        _skipChar = 0;
+        if (c == skip) return true; /* Second half of CRLF or LFCR */
+    }
+
+    size_t write = _queueWrite;
+    size_t used = (write + _queueSize - cli_atomic_load(&_queueHead)) % _queueSize;
+
+    if (c == '\r' || c == '\n') {
+        _skipChar = (c == '\r') ? '\n' : '\r';
+        if (_queuePartialLen == 0) return true; /* Empty lines are not queued */
+        /* Room for the terminator was reserved when the last character was stored */
+        _queue[write] = '\0';
+        _queueWrite = (write + 1) % _queueSize;
+        _queuePartialLen = 0;
+        cli_atomic_store(&_queueCommitted, _queueCommitted + 1); /* Publishes the line */
+    }
+#ifndef CLI_NO_EDITING
+    else if (c == 127 || c == '\b') {
+        if (_queuePartialLen > 0) {
+            _queueWrite = (write + _queueSize - 1) % _queueSize;
+            _queuePartialLen--;
+        }
+    }
+#endif
+    else if (c == CLI_CTRL_C) {
+        /* Cancel the running command and discard the partial line */
+        _queueWrite = (write + _queueSize - _queuePartialLen) % _queueSize;
+        _queuePartialLen = 0;
+        _cancelled = true;
+    }
+    else if (isprint((unsigned char)c)) {
+        /* Keep room for this character and the line terminator */
+        if (_queuePartialLen >= _maxLineLen - 1 || used + 2 >= _queueSize) {
+            return false; /* Line too long or arena full: drop */
+        }
+        _queue[write] = c;
+        _queueWrite = (write + 1) % _queueSize;
+        _queuePartialLen++;
+    }
+    /* Ignore other non-printable characters */
+    return true;
+}
+
+/* Collect everything waiting on the Stream into the queue */
+void ArduinoCLI::_drainToQueue() {
+    bool fed = false;
+    while (_serial->available() > 0) {
+        feedInput((char)_serial->read());
+        fed = true;
+    }
+    /* Only a partial line this thread produced may be taken back (see _restoreQueuedPartial()) */
+    if (fed) _queueStreamPartial = (_queuePartialLen > 0);
+}
+
+/* Consumer side: execute queued lines back-to-back */
+bool ArduinoCLI::_runQueuedLines() {
+    bool ran = false;
+    if (!_queue || !_lineBuffer) return false;
+
+    while (_isRunning && !_dispatchPending && queuedLines() != 0) {
+        size_t head = _queueHead;
+        size_t len = 0;
+        while (_queue[head] != '\0') {
+            if (len < _maxLineLen - 1) _lineBuffer[len++] = _queue[head];
+            head = (head + 1) % _queueSize;
+        }
+        _lineBuffer[len] = '\0';
+        head = (head + 1) % _queueSize; /* Skip terminator */
+
+        cli_atomic_store(&_queueHead, head); /* Frees the line's bytes */
+        cli_atomic_store(&_queueConsumed, _queueConsumed + 1);
+
+        processInput(_lineBuffer);
+        ran = true;
+    }
+    return ran;
+}
+
+/* --- Scheduler --- */
+
+void ArduinoCLI::setScheduler(CLIScheduler* scheduler) {
+    _scheduler = scheduler;
+}
+
+CLIScheduler* ArduinoCLI::getScheduler() {
+    return _scheduler;
+}
+
+/* --- Command Injection Queue --- */
+
+/*
+ * Bounded MPSC ring: each slot carries a sequence number. A slot at position pos is free
+ * for producers when seq == pos, holds a command when seq == pos + 1, and becomes free for
+ * the next lap when the consumer sets seq = pos + slot count.
+ */
+void ArduinoCLI::setInjectQueue(CLIInjectSlot slots[], size_t count) {
+    if (count > CLI_MAX_INJECT_SLOTS) count = CLI_MAX_INJECT_SLOTS;
+    size_t n = 1;
+    while (n * 2 <= count) n *= 2;
+
+    _inject = nullptr;
+    if (!slots || count == 0) return;
+    for (size_t i = 0; i < n; i++) {
+        slots[i].seq = (uint16_t)i;
+        slots[i].sink = nullptr;
+    }
+    _injectMask = (uint16_t)(n - 1);
+    _injectTail = 0;
+    _injectHead = 0;
+    _inject = slots;
+}
+
+/* Producer side: claim a slot with CAS, fill it, then publish it */
+bool ArduinoCLI::inject(const char* line, Print* sink) {
+    CLIInjectSlot* queue = _inject;
+    if (!queue || !line) return false;
+    size_t len = strlen(line);
+    if (len >= CLI_INJECT_LINE_LEN) return false;
+
+    uint16_t pos = cli_atomic_load(&_injectTail);
+    CLIInjectSlot* slot;
+    while (true) {
+        slot = &queue[pos & _injectMask];
+        int16_t diff = (int16_t)(uint16_t)(cli_atomic_load(&slot->seq) - pos);
+        if (diff == 0) {
+            if (cli_atomic_cas(&_injectTail, &pos, (uint16_t)(pos + 1))) break;
+            /* pos was reloaded by the failed CAS */
+        } else if (diff < 0) {
+            return false; /* Full: the consumer has not freed this slot yet */
+        } else {
+            pos = cli_atomic_load(&_injectTail); /* Another producer claimed it */
+        }
+    }
+
+    memcpy(slot->line, line, len + 1);
+    slot->sink = sink;
+    cli_atomic_store(&slot->seq, (uint16_t)(pos + 1));
+    return true;
+}
+
+/* Consumer side: run injected commands with their own output sink */
+void ArduinoCLI::_runInjected() {
+    while (_isRunning) {
+        uint16_t pos = _injectHead;
+        CLIInjectSlot* slot = &_inject[pos & _injectMask];
+        if (cli_atomic_load(&slot->seq) != (uint16_t)(pos + 1)) break; /* Empty (or still being filled) */
+
+        /*
+         * Inline on this thread; the console and any partly typed line are left alone.
+         * The sink gets plain output: frames and their sequence numbers belong to the console.
+         */
+        CLIPrintStream out(slot->sink);
+        Stream* console = _serial;
+        cli_dispatch_hook_t hook = _dispatchHook;
+        bool machine = _machineMode;
+        _serial = &out;
+        _dispatchHook = nullptr;
+        _machineMode = false;
+        _parseAndExecute(slot->line);
+        _serial = console;
+        _dispatchHook = hook;
+        _machineMode = machine;
+
+        _injectHead = (uint16_t)(pos + 1);
+        cli_atomic_store(&slot->seq, (uint16_t)(pos + _injectMask + 1));
+    }
+}
+
+/* Continue editing a line that was typed while the last command ran */
+void ArduinoCLI::_restoreQueuedPartial() {
+    if (!_queueStreamPartial) return;
+    _queueStreamPartial = false;
+
+    /*
+     * The partial line came from _drainToQueue() on this thread, which makes this thread the
+     * queue's producer: no other context is in feedInput(), so it can be taken back directly.
+     */
+    size_t len = _queuePartialLen;
+    size_t pos = (_queueWrite + _queueSize - len) % _queueSize;
+    for (size_t i = 0; i < len; i++) {
+        _lineBuffer[i] = _queue[pos];
+        pos = (pos + 1) % _queueSize;
+    }
+    _lineBuffer[len] = '\0';
+    _bufferPos = len;
+    _queueWrite = (_queueWrite + _queueSize - len) % _queueSize;
+    _queuePartialLen = 0;
+#ifndef CLI_NO_ECHO
+    if (!_machineMode) _serial->print(_lineBuffer);
+#endif
 }
 
 
 /* Poll for input (call in loop) */
 void ArduinoCLI::poll() {
-    if (!_isRunning || !_lineBuffer) return; /* Don't process if stopped or alloc failed */
+    poll((size_t)-1);
+}
 
-    while (_serial.available() > 0) {
-        char c = _serial.read();
+/* Poll with a per-call input budget (fair sharing between sessions) */
+size_t ArduinoCLI::poll(size_t maxBytes) {
+    return _pollStream(*_serial, maxBytes); /* Type-erased: virtual Stream calls */
+}
 
-        /* Handle Line Endings (CR, LF, or CR+LF) */
-        if (c == '\r' || c == '\n') {
-             if (_bufferPos > 0) { /* Process only if buffer has content */
-                 _lineBuffer[_bufferPos] = '\0'; /* Null-terminate */
-                 processInput(_lineBuffer);
-             }
-             /* Reset buffer and print prompt (if still running) */
-             _resetBuffer();
-             if (_isRunning) {
-                 _printPrompt();
-             }
-             /* Skip potential second character of CRLF or LFCR */
-             if (_serial.available() > 0) {
-                 char next_c = _serial.peek();
-                 if ((c == '\r' && next_c == '\n') || (c == '\n' && next_c == '\r')) {
-                     _serial.read(); // Consume the second character
-                 }
-             }
+/* Work done before reading input; false if no input may be read now */
+bool ArduinoCLI::_pollBegin() {
+    if (!_isRunning || !_lineBuffer) return false; /* Don't process if stopped or alloc failed */
+    if (_dispatchPending) return false; /* Buffers belong to the deferred handler */
 
+    /* Commands injected by other tasks or ISRs */
+    if (_inject) _runInjected();
+
+    /* Periodic commands */
+    if (_scheduler) _scheduler->_service(*this);
+
+    /* Lines fed into the queue from elsewhere (e.g., an ISR) while idle */
+    if (_bufferPos == 0 && _runQueuedLines()) {
+        if (_dispatchPending) {
+            _pendingTerminator = 0;
+            return false;
         }
-        /* Handle Tab Completion */
-        else if (c == '\t') {
-            _handleTab();
-        }
-        /* Handle Backspace/Delete */
-        else if (c == 127 || c == '\b') { /* Handle DEL and Backspace */
-            if (_bufferPos > 0) {
-                _bufferPos--;
-                _lineBuffer[_bufferPos] = '\0';
-                /* Attempt visual backspace - may not work on all terminals */
-                _serial.write("\b \b");
-            }
+        _endLine(0);
+    }
+    return true;
+}
+
+/* Everything but printable characters; false if a command was deferred */
+bool ArduinoCLI::_processControl(char c) {
+    /* Handle Line Endings (CR, LF, or CR+LF) */
+    if (c == '\r' || c == '\n') {
+         if (_bufferPos > 0) { /* Process only if buffer has content */
+             _lineBuffer[_bufferPos] = '\0'; /* Null-terminate */
+#ifndef CLI_NO_EDITING
+             if (_history && !_machineMode) _addHistory(_lineBuffer, _bufferPos);
+#endif
+             processInput(_lineBuffer);
+             /* Run lines typed ahead while the command executed */
+             if (!_dispatchPending) _runQueuedLines();
+             if (_dispatchPending) {
+                 _pendingTerminator = c; /* Resumed by completeDispatch() */
+                 return false;
+             }
+         }
+         _endLine(c);
+    }
+#ifndef CLI_NO_TAB_COMPLETION
+    /* Handle Tab Completion */
+    else if (c == '\t') {
+        if (!_machineMode) _handleTab();
+    }
+#endif
+#ifndef CLI_NO_EDITING
+    /* Handle Backspace/Delete */
+    else if (c == 127 || c == '\b') { /* Handle DEL and Backspace */
+        if (_bufferPos > 0) {
+            _bufferPos--;
+            _lineBuffer[_bufferPos] = '\0';
+#ifndef CLI_NO_ECHO
+            /* Attempt visual backspace - may not work on all terminals */
+            if (!_machineMode) _serial->write("\b \b");
+#endif
         }
-         /* Handle Ctrl+C (End of Text) - Simple version: clear line */
-        else if (c == 3) {
-            _resetBuffer();
-            _serial.println("^C");
+    }
+    /* Start of an arrow key sequence (see _escapeByte()) */
+    else if (c == CLI_CTRL_ESC) {
+        if (!_machineMode) _escape = 1;
+    }
+    /* Reverse history search (see _searchByte()) */
+    else if (c == CLI_CTRL_R) {
+        _startSearch();
+    }
+#endif
+     /* Handle Ctrl+C (End of Text) - Simple version: clear line */
+    else if (c == CLI_CTRL_C) {
+        _resetBuffer();
+#ifndef CLI_NO_ECHO
+        if (!_machineMode) _serial->println("^C");
+#endif
+        _printPrompt();
+    }
+    /* Switch between the console and framed responses; drops a partial line */
+    else if (c == CLI_CTRL_MACHINE) {
+        _resetBuffer();
+        if (setMachineMode(true)) _writeFrame(CLI_RESULT_OK, 0); /* Frame 0 acknowledges */
+    }
+    /* Only from a host: at the console Ctrl+N is next-history, and there is no text way back */
+    else if (c == CLI_CTRL_BINARY && _machineMode) {
+        _resetBuffer();
+        setBinaryMode(true);
+    }
+    else if (c == CLI_CTRL_HUMAN) {
+        _resetBuffer();
+        if (_machineMode) {
+            setMachineMode(false);
             _printPrompt();
         }
-        /* Handle printable characters */
-        else if (isprint(c)) {
-            if (_bufferPos < _maxLineLen - 1) {
-                _lineBuffer[_bufferPos++] = c;
-                _lineBuffer[_bufferPos] = '\0'; /* Keep null-terminated */
-                _printChar(c); /* Echo character */
-            } else {
-                /* Buffer full: optional bell sound */
-                _serial.write('\a');
-            }
+    }
+    /* Ignore other non-printable characters */
+    return true;
+}
+
+/* Reset buffer, print prompt (if still running), swallow CRLF/LFCR pair */
+void ArduinoCLI::_endLine(char terminator) {
+    _resetBuffer();
+    if (_isRunning) {
+        _printPrompt();
+        if (_queue) _restoreQueuedPartial();
+    }
+    /* Skip potential second character of CRLF or LFCR */
+    if (terminator && _serial->available() > 0) {
+        char next_c = _serial->peek();
+        if ((terminator == '\r' && next_c == '\n') || (terminator == '\n' && next_c == '\r')) {
+            _serial->read(); // Consume the second character
         }
-        /* Ignore other non-printable characters */
     }
 }
 
+/* --- Deferred Dispatch --- */
+
+void ArduinoCLI::setDispatchHook(cli_dispatch_hook_t hook, void* ctx) {
+    _dispatchHook = hook;
+    _dispatchCtx = ctx;
+}
+
+bool ArduinoCLI::isDispatchPending() const {
+    return _dispatchPending;
+}
+
+void* ArduinoCLI::getContext() const {
+    return _command ? _command->ctx : nullptr;
+}
+
+int ArduinoCLI::getStatus() const {
+    return _status;
+}
+
+/* Called once the deferred handler has returned */
+void ArduinoCLI::completeDispatch(int status) {
+    if (!_dispatchPending) return;
+    _dispatchPending = false;
+    _status = status;
+    if (_cancelled) _chain = nullptr; /* Ctrl+C drops the rest of the line */
+    _endCommand();
+    _unpinTable();
+
+    _runChain();
+    if (_dispatchPending) return; /* Next command of the chain was deferred too */
+    _runQueuedLines();
+    if (_dispatchPending) return; /* Next queued line was deferred too */
+    _endLine(_pendingTerminator);
+}
+
+void ArduinoCLI::cancelDispatch() {
+    if (!_dispatchPending) return;
+    _dispatchPending = false;
+    _status = CLI_STATUS_FAIL;
+    _chain = nullptr;
+    _cancelled = false;
+    _unpinTable();
+}
+
 /* Process a completed line */
 void ArduinoCLI::processInput(char* line) {
      if (!_isRunning || !_lineBuffer || !_argv) return; /* Safety checks */
+     /* Lines from the link, not those a handler runs */
+     if (_checksum != CLI_CHECKSUM_NONE && _command == nullptr && !_checkLine(line)) {
+         if (_machineMode) {
+             _writeFrame(CLI_RESULT_BAD_FRAME, 0);
+         } else {
+             _serial->println();
+             if (_format != CLI_FORMAT_TEXT) _formatError(F("checksum"));
+             else _serial->println(F("NAK"));
+         }
+         _status = CLI_STATUS_FAIL;
+         return;
+     }
      _parseAndExecute(line);
 }
 
@@ -222,109 +970,616 @@ int ArduinoCLI::_splitLine(char *line, char **argv_local, size_t max_args_local)
 
 
 /* Find command based on prefix */
-const CLI_Command_t* ArduinoCLI::_findCommand(const char *prefix) {
-    const CLI_Command_t *found_cmd = NULL;
-    const CLI_Command_t *exact_match = NULL;
-    int match_count = 0;
-    size_t prefix_len = strlen(prefix);
+const CLI_Command_t* ArduinoCLI::_findCommand(const char *prefix, int *matchCount) {
+    return _table->find(prefix, matchCount);
+}
 
-    if (prefix_len == 0) return NULL;
+/* --- Runtime Command Registry --- */
 
-    for (size_t i = 0; i < _commandCount; i++) {
-         if (_commands[i].name == NULL) continue; /* Skip potentially null entries if any */
+bool ArduinoCLI::setCommandRegistry(CLICommandRegistry* registry) {
+    if (_registry) {
+        _registry->unregisterReader(_readerSlot);
+        _registry = nullptr;
+        _readerSlot = -1;
+    }
+    if (!registry) return true;
+
+    int slot = registry->registerReader();
+    if (slot < 0) return false;
+    _registry = registry;
+    _readerSlot = slot;
+    return true;
+}
+
+void ArduinoCLI::_pinTable() {
+    if (!_registry || _tablePins++ != 0) return;
+    _unpinnedTable = _table;
+    const CLICommandTable* table = _registry->acquire(_readerSlot);
+    if (table) _table = table; /* Else keep the fixed table */
+}
+
+void ArduinoCLI::_unpinTable() {
+    if (!_registry || _tablePins == 0 || --_tablePins != 0) return;
+    _table = _unpinnedTable;
+    _registry->release(_readerSlot);
+}
+
+/* Parse input line and execute the command; the table stays pinned while a deferred command runs */
+void ArduinoCLI::_parseAndExecute(char *line) {
+    if (!_lineBuffer || !_argv) return; /* Alloc check */
+
+    /* A handler may run a line of its own; resume its chain afterwards */
+    char *outer = _chain;
+    uint8_t outerOp = _chainOp;
+    const char *outerId = _requestId;
 
-        /* Check for exact match */
-        if (strcmp(prefix, _commands[i].name) == 0) {
-            exact_match = &_commands[i];
+    /* "#id cmd ...": the id tags every frame of the line */
+    _requestId = nullptr;
+    if (_machineMode) {
+        while (*line == ' ' || *line == '\t') line++;
+        if (*line == '#') {
+            _requestId = ++line;
+            while (*line && !cli_is_delim(*line)) line++;
+            if (*line) *line++ = '\0';
         }
-        /* Check for prefix match */
-        if (strncmp(prefix, _commands[i].name, prefix_len) == 0) {
-            if (found_cmd == NULL) {
-                found_cmd = &_commands[i]; /* First potential match */
+    }
+    uint16_t seq = _frameSeq;
+
+    _chain = line;
+    _chainOp = CLI_CHAIN_ALWAYS;
+    _status = CLI_STATUS_OK;
+    _runChain();
+
+    /* A tagged line is always answered, even if it held no command */
+    if (_requestId && _frameSeq == seq) _writeFrame(CLI_RESULT_OK, 0);
+    _requestId = outerId;
+    if (!_dispatchPending) {
+        _chain = outer;
+        _chainOp = outerOp;
+    }
+}
+
+void ArduinoCLI::_runChain() {
+    while (_chain && _isRunning && !_dispatchPending) {
+        uint8_t op = _chainOp;
+
+        /* Tokenizing modifies the string, which is fine as _lineBuffer holds the command */
+        int argc = _splitCommand(&_chain, _argv, _maxArgs, &_chainOp);
+        if (argc == 0) continue; /* Empty command */
+
+        /* Like a shell, a skipped command leaves the status unchanged */
+        if ((op == CLI_CHAIN_AND && _status != CLI_STATUS_OK) ||
+            (op == CLI_CHAIN_OR && _status == CLI_STATUS_OK)) {
+            _skipPipeline();
+            if (_machineMode) _writeFrame(CLI_RESULT_SKIPPED, 0);
+            continue;
+        }
+
+        _pinTable();
+        int status;
+        if (_machineMode) status = _runFramed(argc);
+        else status = (_chainOp == CLI_CHAIN_PIPE) ? _runPipeline(argc) : _executePinned(argc);
+        if (_dispatchPending) return; /* Table stays pinned until completeDispatch() */
+        _status = status;
+        _unpinTable();
+    }
+}
+
+/* --- Pipes --- */
+
+void ArduinoCLI::setPipeBuffer(char* buffer, size_t size) {
+    _pipeBuffer = (buffer && size > 0) ? buffer : nullptr;
+    _pipeSize = _pipeBuffer ? size : 0;
+}
+
+void ArduinoCLI::_skipPipeline() {
+    while (_chainOp == CLI_CHAIN_PIPE) {
+        _splitCommand(&_chain, _argv, _maxArgs, &_chainOp);
+    }
+}
+
+/* True if another '|' follows before the end of the pipeline */
+static bool cli_more_pipes(const char* p) {
+    for (; p && *p; p++) {
+        uint8_t op = cli_chain_op(p);
+        if (op == CLI_CHAIN_PIPE) return true;
+        if (op != CLI_CHAIN_END) return false;
+    }
+    return false;
+}
+
+/*
+ * Stages run one after another: each handler's output fills a pipe that the next
+ * handler reads as its input, and the last one writes to the console. Inline only,
+ * since a stage's argv and the pipes live on this call's stack.
+ */
+int ArduinoCLI::_runPipeline(int argc) {
+    Stream* console = _serial;
+    if (!_pipeBuffer) {
+        if (!_machineMode) { /* Else the frame's result code (CLI_RESULT_FAILED) says it all */
+            console->println();
+            if (_format != CLI_FORMAT_TEXT) _formatError(F("pipes_disabled"));
+            else console->println(F("Error: Pipes are not enabled."));
+        }
+        _skipPipeline();
+        return CLI_STATUS_FAIL;
+    }
+
+    /* Two stages share the whole buffer; longer pipelines alternate between two halves */
+    size_t first = cli_more_pipes(_chain) ? _pipeSize / 2 : _pipeSize;
+    CLIPipe pipes[2] = {
+        CLIPipe(_pipeBuffer, first, this),
+        CLIPipe(_pipeBuffer + first, _pipeSize - first, this)
+    };
+    CLIPipe* in = nullptr;
+
+    /* A stage's input is the pipe, not type-ahead; hooks would run it on another thread */
+    char* queue = _queue;
+    _queue = nullptr;
+    cli_dispatch_hook_t hook = _dispatchHook;
+    _dispatchHook = nullptr;
+
+    int status = CLI_STATUS_OK;
+    bool truncated = false;
+    bool cancelled = false;
+    if (!_machineMode) console->println();
+    for (uint8_t stage = 0; ; stage++) {
+        CLIPipe* out = (_chainOp == CLI_CHAIN_PIPE) ? &pipes[stage & 1] : nullptr;
+        const CLI_Command_t* cmd = _resolve(argc); /* Errors go to the console */
+        if (cmd == NULL) {
+            status = CLI_STATUS_FAIL;
+            break;
+        }
+
+        status = CLI_STATUS_OK;
+        if (out) out->clear();
+        if (cmd->func != NULL) {
+            CLIPrintStream io(out ? (Print*)out : (Print*)console, in ? (Stream*)in : console);
+            _serial = &io;
+            _cancelled = false;
+            _checkpointCountdown = _checkpointInterval;
+            _resetWriters();
+            status = cli_invoke(cmd, this, argc, _argv);
+            _serial = console;
+        }
+        if (out && out->overflowed()) {
+            truncated = true;
+            _cancelled = false; /* Requested by the pipe, not by Ctrl+C */
+        }
+        if (_cancelled) {
+            cancelled = true;
+            break;
+        }
+        if (!out) break; /* Last stage */
+
+        argc = _splitCommand(&_chain, _argv, _maxArgs, &_chainOp);
+        if (argc == 0) {
+            if (_machineMode) {
+                /* The frame's result code says it all */
+            } else if (_format != CLI_FORMAT_TEXT) {
+                _formatError(F("missing_command"));
+            } else {
+                console->println(F("Error: Missing command after '|'."));
             }
-            match_count++;
+            status = CLI_STATUS_FAIL;
+            break;
         }
+        in = out;
     }
+    _skipPipeline();
 
-    /* Preference rule: Exact match wins */
-    if (exact_match) {
-        return exact_match;
+    _queue = queue;
+    _dispatchHook = hook;
+    if (cancelled) {
+        _chain = nullptr; /* Ctrl+C drops the rest of the line */
+        _endCommand();
+    }
+    if (truncated) {
+        if (_machineMode) {
+            /* The frame's result code says it all */
+        } else if (_format != CLI_FORMAT_TEXT) {
+            _formatError(F("pipe_full"));
+        } else {
+            console->println(F("Error: Pipe full, output truncated."));
+        }
+        status = CLI_STATUS_FAIL;
     }
+    return status;
+}
 
-    /* If no exact match, check prefix matches */
-    if (match_count == 1) {
-        return found_cmd; /* Unique prefix match */
+/* --- JSON and CBOR Output --- */
+
+/* The writers share their calls, so one template produces either format */
+
+/* {"error":..,"command":..[,"max_args":..,"got":..]}; always a new document (see _formatError()) */
+template <class W>
+static void cli_write_error(W& out, const __FlashStringHelper* error, const char* command,
+                            int maxArgs = -1, int got = -1) {
+    out.reset();
+    out.beginObject((command ? 2 : 1) + (maxArgs >= 0 ? 2 : 0)).key(F("error")).value(error);
+    if (command) out.key(F("command")).value(command);
+    if (maxArgs >= 0) out.key(F("max_args")).value(maxArgs).key(F("got")).value(got);
+    out.endObject();
+}
+
+/* {"commands":[{"name":..,"help":..,"max_args":..},...]}, or names only with CLI_NO_HELP */
+template <class W>
+static void cli_write_commands(W& out, const CLICommandTable* table) {
+    out.reset();
+    out.beginObject(1).key(F("commands")).beginArray();
+    for (size_t i = 0; i < table->count(); i++) {
+        const CLI_Command_t *cmd = table->command(i);
+        if (cmd->name == NULL) continue;
+#ifdef CLI_NO_HELP
+        out.value(cmd->name);
+#else
+        out.beginObject(3).key(F("name")).value(cmd->name).key(F("help")).value(cmd->help_text)
+           .key(F("max_args")).value(cmd->max_args).endObject();
+#endif
     }
+    out.endArray().endObject();
+}
 
-    return NULL; /* Ambiguous or not found */
+CLIJsonWriter& ArduinoCLI::json() {
+    _json.setOutput(_serial);
+    return _json;
 }
 
-/* Parse input line and execute the command */
-void ArduinoCLI::_parseAndExecute(char *line) {
-    if (!_lineBuffer || !_argv) return; /* Alloc check */
+void ArduinoCLI::setJsonMode(bool enable) {
+    if (enable) _format = CLI_FORMAT_JSON;
+    else if (_format == CLI_FORMAT_JSON) _format = CLI_FORMAT_TEXT;
+}
+
+bool ArduinoCLI::isJsonMode() const {
+    return _format == CLI_FORMAT_JSON;
+}
+
+CLICborWriter& ArduinoCLI::cbor() {
+    _cbor.setOutput(_serial);
+    return _cbor;
+}
+
+void ArduinoCLI::setCborMode(bool enable) {
+    if (enable) _format = CLI_FORMAT_CBOR;
+    else if (_format == CLI_FORMAT_CBOR) _format = CLI_FORMAT_TEXT;
+}
+
+bool ArduinoCLI::isCborMode() const {
+    return _format == CLI_FORMAT_CBOR;
+}
 
-    /* Skip leading whitespace */
-    while (isspace((unsigned char)*line)) line++;
+/* A top-level command starts a new document; commands run by a handler write into its own */
+void ArduinoCLI::_resetWriters() {
+    if (_command) return;
+    _json.reset();
+    _cbor.reset();
+}
 
-    if (*line == '\0') {
-        return; /* Empty line */
+/* A handler stopped midway (Ctrl+C, a full pipe) may leave its document open: close it first */
+void ArduinoCLI::_formatError(const __FlashStringHelper* error, const char* command) {
+    if (_format == CLI_FORMAT_CBOR) {
+        cbor().end();
+        cli_write_error(cbor(), error, command);
+    } else {
+        if (json().depth() > 0) {
+            _json.end();
+            _serial->println();
+        }
+        cli_write_error(json(), error, command);
+        _serial->println();
     }
+}
 
-    /* strtok modifies the string, which is fine as _lineBuffer holds the command */
-    int argc = _splitLine(line, _argv, _maxArgs);
+/* --- Line Checksums --- */
 
-    if (argc == 0) {
-        return; /* Line had only whitespace */
+/* CRC-8/SMBUS half-byte table */
+static const uint8_t cli_crc8_table[16] PROGMEM = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+
+static uint8_t cli_checksum_byte(uint8_t mode, uint8_t sum, uint8_t b) {
+    if (mode == CLI_CHECKSUM_NMEA) return sum ^ b;
+    sum = (uint8_t)(sum << 4) ^ pgm_read_byte(&cli_crc8_table[(sum >> 4) ^ (b >> 4)]);
+    return (uint8_t)(sum << 4) ^ pgm_read_byte(&cli_crc8_table[(sum >> 4) ^ (b & 0x0F)]);
+}
+
+static int cli_hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static char cli_hex_char(uint8_t v) {
+    return (char)(v < 10 ? '0' + v : 'A' + v - 10);
+}
+
+/* Print forwarding to another one and summing what passes through */
+class CLIChecksumPrint : public Print {
+public:
+    CLIChecksumPrint(Print& target, uint8_t mode) : sum(0), _target(target), _mode(mode) {}
+
+    size_t write(uint8_t c) override {
+        sum = cli_checksum_byte(_mode, sum, c);
+        return _target.write(c);
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        for (size_t i = 0; i < size; i++) sum = cli_checksum_byte(_mode, sum, buffer[i]);
+        return _target.write(buffer, size);
     }
+    using Print::write;
 
-    const CLI_Command_t *cmd = _findCommand(_argv[0]);
+    uint8_t sum;                /**< Checksum so far. */
 
-    if (cmd == NULL) {
-        /* Check for ambiguity for error message */
-        int match_count = 0;
-        size_t prefix_len = strlen(_argv[0]);
-         for (size_t i = 0; i < _commandCount; i++) {
-             if (_commands[i].name != NULL && strncmp(_argv[0], _commands[i].name, prefix_len) == 0) {
-                 match_count++;
-             }
+private:
+    Print& _target;
+    uint8_t _mode;
+};
+
+void ArduinoCLI::setLineChecksum(uint8_t mode) {
+    _checksum = (mode <= CLI_CHECKSUM_CRC8) ? mode : CLI_CHECKSUM_NONE;
+}
+
+bool ArduinoCLI::_checkLine(char* line) {
+    size_t len = strlen(line);
+    if (len < 3 || line[len - 3] != '*') return false;
+    int hi = cli_hex_digit(line[len - 2]);
+    int lo = cli_hex_digit(line[len - 1]);
+    if (hi < 0 || lo < 0) return false;
+
+    uint8_t sum = 0;
+    for (size_t i = 0; i < len - 3; i++) sum = cli_checksum_byte(_checksum, sum, (uint8_t)line[i]);
+    if (sum != (uint8_t)((hi << 4) | lo)) return false;
+    line[len - 3] = '\0';
+    return true;
+}
+
+/* --- Machine Mode --- */
+
+void ArduinoCLI::setResponseBuffer(char* buffer, size_t size) {
+    _responseBuffer = (buffer && size > 0) ? buffer : nullptr;
+    _responseSize = _responseBuffer ? size : 0;
+    if (!_responseBuffer) _machineMode = false;
+    if (_responseSize <= CLI_BINARY_OVERHEAD) _binaryMode = false;
+}
+
+bool ArduinoCLI::setMachineMode(bool enable) {
+    if (enable && !_responseBuffer) return false;
+    if (enable && !_machineMode) _frameSeq = 0;
+    _machineMode = enable;
+    return true;
+}
+
+bool ArduinoCLI::isMachineMode() const {
+    return _machineMode;
+}
+
+/* "!<seq> <result> <length>[ #<id>]\n", the payload and, with line checksums, "*XX\n" */
+void ArduinoCLI::_writeFrame(uint8_t result, size_t len) {
+    CLIChecksumPrint summed(*_serial, _checksum);
+    Print& out = (_checksum != CLI_CHECKSUM_NONE) ? (Print&)summed : (Print&)*_serial;
+    out.print('!');
+    out.print(_frameSeq++);
+    out.print(' ');
+    out.print(result);
+    out.print(' ');
+    out.print(len);
+    if (_requestId) {
+        out.print(F(" #"));
+        out.print(_requestId);
+    }
+    out.print('\n');
+
+    /* Keep taking pipelined requests off the Stream while a long payload goes out */
+    const uint8_t* p = (const uint8_t*)_responseBuffer;
+    while (len > 0) {
+        size_t n = (len > CLI_FRAME_CHUNK) ? CLI_FRAME_CHUNK : len;
+        out.write(p, n);
+        p += n;
+        len -= n;
+        if (_queue) _drainToQueue();
+    }
+
+    if (_checksum != CLI_CHECKSUM_NONE) {
+        _serial->print('*');
+        _serial->print(cli_hex_char(summed.sum >> 4));
+        _serial->print(cli_hex_char(summed.sum & 0x0F));
+        _serial->print('\n');
+    }
+}
+
+/*
+ * The handler writes into a pipe over the response buffer, so the frame's length is known
+ * before it is sent. Inline only: a hook would return before the output is complete.
+ */
+int ArduinoCLI::_runFramed(int argc) {
+    Stream* console = _serial;
+    CLIPipe out(_responseBuffer, _responseSize, this);
+    CLIPrintStream io(&out, console); /* Input (Ctrl+C) still comes from the console */
+    cli_dispatch_hook_t hook = _dispatchHook;
+    _dispatchHook = nullptr;
+    _serial = &io;
+    _result = CLI_RESULT_OK;
+
+    int status = (_chainOp == CLI_CHAIN_PIPE) ? _runPipeline(argc) : _executePinned(argc);
+
+    _serial = console;
+    _dispatchHook = hook;
+    uint8_t result = _result;
+    if (out.overflowed()) {
+        result = CLI_RESULT_OVERFLOW;
+        status = CLI_STATUS_FAIL;
+    } else if (result == CLI_RESULT_OK && status != CLI_STATUS_OK) result = CLI_RESULT_FAILED;
+    /* Never read, so the output starts at the beginning of the buffer */
+    _writeFrame(result, (size_t)out.available());
+    return status;
+}
+
+int ArduinoCLI::_executePinned(int argc) {
+    const CLI_Command_t *cmd = _resolve(argc);
+    if (cmd == NULL) return CLI_STATUS_FAIL;
+
+    /* Execute command */
+    int status = CLI_STATUS_OK;
+    if (cmd->func != NULL) {
+        if (!_machineMode) _serial->println();
+        _cancelled = false;
+        _checkpointCountdown = _checkpointInterval;
+        _resetWriters();
+        if (_dispatchHook) {
+            _dispatchPending = true; /* Set first: the handler may start immediately */
+            if (_dispatchHook(_dispatchCtx, this, cmd, argc, _argv)) return CLI_STATUS_OK;
+            _dispatchPending = false;
         }
+        /* Pass 'this' pointer so command can access serial etc. if needed */
+        status = cli_invoke(cmd, this, argc, _argv);
+        if (_cancelled) _chain = nullptr; /* Ctrl+C drops the rest of the line */
+        _endCommand();
+    }
+    return status;
+}
 
-        _serial.println();
-        if (match_count > 1) {
-             _serial.print(F("Error: Ambiguous command '"));
-             _serial.print(_argv[0]);
-             _serial.println(F("'."));
+const CLI_Command_t* ArduinoCLI::_resolve(int argc) {
+    int match_count = 0;
+    const CLI_Command_t *cmd = _findCommand(_argv[0], &match_count);
+
+    if (cmd == NULL) {
+        /* match_count tells ambiguity apart for the error message */
+        _result = (match_count > 1) ? CLI_RESULT_AMBIGUOUS : CLI_RESULT_UNKNOWN;
+        if (_machineMode) return NULL; /* The frame's result code says it all */
+        _serial->println();
+        if (_format != CLI_FORMAT_TEXT) {
+            _formatError(match_count > 1 ? F("ambiguous") : F("unknown"), _argv[0]);
+        } else if (match_count > 1) {
+             _serial->print(F("Error: Ambiguous command '"));
+             _serial->print(_argv[0]);
+             _serial->println(F("'."));
         } else {
-             _serial.print(F("Error: Unknown command '"));
-             _serial.print(_argv[0]);
-             _serial.println(F("'. Type 'help' for list."));
+             _serial->print(F("Error: Unknown command '"));
+             _serial->print(_argv[0]);
+#ifdef CLI_NO_HELP
+             _serial->println(F("'."));
+#else
+             _serial->println(F("'. Type 'help' for list."));
+#endif
         }
-        return; // Exit after printing error
+        return NULL; // Exit after printing error
     }
 
     /* Validate argument count */
     int user_args = argc - 1;
     if (user_args > cmd->max_args) {
+        _result = CLI_RESULT_TOO_MANY_ARGS;
+        if (_machineMode) return NULL;
 
-        _serial.println();
-        _serial.print(F("Error: Too many arguments for '"));
-        _serial.print(cmd->name);
-        _serial.print(F("' (max: "));
-        _serial.print(cmd->max_args);
-        _serial.print(F(", got: "));
-        _serial.print(user_args);
-        _serial.println(F(")."));
-        return; // Exit after printing error
+        _serial->println();
+        if (_format == CLI_FORMAT_CBOR) {
+            cli_write_error(cbor(), F("too_many_args"), cmd->name, cmd->max_args, user_args);
+            return NULL;
+        } else if (_format == CLI_FORMAT_JSON) {
+            cli_write_error(json(), F("too_many_args"), cmd->name, cmd->max_args, user_args);
+            _serial->println();
+            return NULL;
+        }
+        _serial->print(F("Error: Too many arguments for '"));
+        _serial->print(cmd->name);
+        _serial->print(F("' (max: "));
+        _serial->print(cmd->max_args);
+        _serial->print(F(", got: "));
+        _serial->print(user_args);
+        _serial->println(F(")."));
+        return NULL; // Exit after printing error
     }
+    return cmd;
+}
 
-    /* Execute command */
-    if (cmd->func != NULL) {
-        _serial.println();
-        /* Pass 'this' pointer so command can access serial etc. if needed */
-        cmd->func(this, argc, _argv);
+/* --- Prepared Commands --- */
+
+uint8_t ArduinoCLI::prepare(const char* line, CLIPreparedCommand* prepared) {
+    prepared->cmd = nullptr;
+    prepared->name = nullptr;
+    prepared->argc = 0;
+    prepared->argv[0] = NULL;
+
+    size_t len = line ? strlen(line) : 0;
+    if (len >= CLI_PREPARED_LINE_LEN) {
+        prepared->status = CLI_PREPARE_TOO_LONG;
+        return prepared->status;
     }
+    memcpy(prepared->line, line ? line : "", len + 1);
+
+    /* Same tokenizing rules as processInput(); one spare slot detects lines with too many arguments */
+    char* argv[CLI_PREPARED_MAX_ARGS + 3];
+    int argc = _splitSingle(prepared->line, argv, CLI_PREPARED_MAX_ARGS + 3);
+    if (argc < 0) {
+        prepared->status = CLI_PREPARE_OPERATOR; /* A handle runs one command */
+        return prepared->status;
+    }
+    if (argc == 0) {
+        prepared->status = CLI_PREPARE_EMPTY;
+        return prepared->status;
+    }
+
+    _pinTable();
+    int match_count = 0;
+    const CLI_Command_t* cmd = _findCommand(argv[0], &match_count);
+    if (cmd == NULL) {
+        prepared->status = (match_count > 1) ? CLI_PREPARE_AMBIGUOUS : CLI_PREPARE_UNKNOWN;
+    } else if (argc - 1 > cmd->max_args || argc - 1 > CLI_PREPARED_MAX_ARGS) {
+        prepared->status = CLI_PREPARE_TOO_MANY_ARGS;
+    } else {
+        prepared->status = CLI_PREPARE_OK;
+        prepared->cmd = cmd;
+        prepared->name = cmd->name;
+        prepared->argc = (uint8_t)argc;
+        memcpy(prepared->argv, argv, (argc + 1) * sizeof(char*));
+    }
+    _unpinTable();
+    return prepared->status;
+}
+
+bool ArduinoCLI::execute(CLIPreparedCommand* prepared) {
+    _pinTable();
+    bool ran = _runPrepared(prepared);
+    if (ran) _endCommand();
+    _unpinTable();
+    return ran;
 }
 
+bool ArduinoCLI::_runPrepared(CLIPreparedCommand* prepared) {
+    if (prepared->status != CLI_PREPARE_OK) return false;
+
+    const CLI_Command_t* cmd = prepared->cmd;
+    if (_registry) {
+        /* The snapshot the handle was prepared against may be gone; a prefix match would run another command */
+        cmd = _table->find(prepared->name);
+        if (cmd == NULL || strcmp(cmd->name, prepared->name) != 0 || cmd->max_args < prepared->argc - 1) {
+            prepared->cmd = nullptr;
+            prepared->status = CLI_PREPARE_REMOVED;
+            return false;
+        }
+    }
+    if (cmd->func == NULL) return true;
+
+    _cancelled = false;
+    _checkpointCountdown = _checkpointInterval;
+    _resetWriters();
+    cli_invoke(cmd, this, prepared->argc, prepared->argv);
+    return true;
+}
+
+/* Report a cancelled command */
+void ArduinoCLI::_endCommand() {
+    if (_cancelled) {
+        _result = CLI_RESULT_CANCELLED;
+        if (_format != CLI_FORMAT_TEXT && !_machineMode) _formatError(F("cancelled"));
+        else if (!_machineMode) _serial->println(F("^C"));
+        _cancelled = false;
+    }
+}
+
+#ifndef CLI_NO_TAB_COMPLETION
 /* --- Tab Completion Logic (Arduino Adaptation) --- */
 
 /* Find Longest Common Prefix */
@@ -355,38 +1610,31 @@ int ArduinoCLI::_findLcp(const char *matches[], int count) {
 void ArduinoCLI::_handleTab() {
     if (!_lineBuffer) return; /* Check allocation */
 
-    /* Extract the current word being typed (only completes first word/command) */
-    char current_word[CLI_DEFAULT_MAX_LINE_LEN];
-    strncpy(current_word, _lineBuffer, _bufferPos);
-    current_word[_bufferPos] = '\0';
+    /* The word being typed is the line itself (only completes first word/command) */
+    _lineBuffer[_bufferPos] = '\0';
+    const char* current_word = _lineBuffer;
 
     /* Don't complete if there's a space (only complete command name) */
-    if (strchr(current_word, ' ')) {
-       _serial.write('\a'); /* Bell sound - can't complete args yet */
+    if (memchr(current_word, ' ', _bufferPos)) {
+       _serial->write('\a'); /* Bell sound - can't complete args yet */
        return;
     }
-    size_t current_len = strlen(current_word);
+    size_t current_len = _bufferPos;
     if (current_len == 0) return; /* Nothing to complete */
 
 
     /* Find matches */
-    const char *matches[_commandCount];
+    _pinTable();
     int match_count = 0;
-    for (size_t i = 0; i < _commandCount; i++) {
-        if (_commands[i].name != NULL && strncmp(current_word, _commands[i].name, current_len) == 0) {
-             if ((size_t)match_count < _commandCount) {
-                matches[match_count++] = _commands[i].name;
-             } else {
-                break; /* Should not happen */
-             }
-        }
-    }
-
-
+    _findCommand(current_word, &match_count);
     if (match_count == 0) {
-        _serial.write('\a'); /* Bell sound */
+        _unpinTable();
+        _serial->write('\a'); /* Bell sound */
         return;
     }
+    const char *matches[match_count];
+    match_count = _table->collectMatches(current_word, matches, match_count);
+    _unpinTable(); /* Name strings outlive the snapshot */
 
     if (match_count == 1) {
         /* Single match: try to complete inline */
@@ -400,12 +1648,12 @@ void ArduinoCLI::_handleTab() {
             _lineBuffer[_bufferPos + remaining_len] = ' ';
             _lineBuffer[_bufferPos + remaining_len + 1] = '\0';
 
-            _serial.print(completion + current_len);
-            _serial.print(' ');
+            _serial->print(completion + current_len);
+            _serial->print(' ');
 
             _bufferPos += remaining_len + 1;
         } else {
-            _serial.write('\a'); /* Not enough space */
+            _serial->write('\a'); /* Not enough space */
         }
     } else { // match_count > 1
         /* Multiple matches: find LCP */
@@ -417,45 +1665,70 @@ void ArduinoCLI::_handleTab() {
                 strncpy(_lineBuffer + _bufferPos, matches[0] + current_len, remaining_len);
                 _lineBuffer[_bufferPos + remaining_len] = '\0';
 
-                _serial.print(matches[0] + current_len);
+                _serial->print(matches[0] + current_len);
                 _bufferPos += remaining_len;
             } else {
-                 _serial.write('\a'); /* Not enough space */
+                 _serial->write('\a'); /* Not enough space */
             }
         } else {
             /* LCP is same as current input: list options */
-            _serial.println(); /* Newline before listing */
+            _serial->println(); /* Newline before listing */
             for (int i = 0; i < match_count; i++) {
-                _serial.print(matches[i]);
-                _serial.print("  "); /* Add some spacing */
+                _serial->print(matches[i]);
+                _serial->print("  "); /* Add some spacing */
             }
             /* Reprint prompt and current buffer */
             _printPrompt();
-            _serial.print(_lineBuffer);
+            _serial->print(_lineBuffer);
         }
     }
 }
+#endif /* CLI_NO_TAB_COMPLETION */
 
 
 /* --- Help Command Helper --- */
 /* Can be called from the user-defined help command handler */
 void ArduinoCLI::printHelp() {
-    _serial.println(F("Available commands:"));
-    for (size_t i = 0; i < _commandCount; i++) {
-         if (_commands[i].name == NULL) continue;
-        _serial.print(F("  "));
-        _serial.print(_commands[i].name);
+    _pinTable();
+    if (_format == CLI_FORMAT_CBOR) {
+        cli_write_commands(cbor(), _table);
+        _unpinTable();
+        return;
+    } else if (_format == CLI_FORMAT_JSON) {
+        cli_write_commands(json(), _table);
+        _serial->println();
+        _unpinTable();
+        return;
+    }
+#ifdef CLI_NO_HELP
+    /* Names only: no help strings, padding or labels in flash */
+    for (size_t i = 0; i < _table->count(); i++) {
+        const CLI_Command_t *cmd = _table->command(i);
+        if (cmd->name == NULL) continue;
+        _serial->print(cmd->name);
+        _serial->print(' ');
+    }
+    _serial->println();
+#else
+    _serial->println(F("Available commands:"));
+    for (size_t i = 0; i < _table->count(); i++) {
+        const CLI_Command_t *cmd = _table->command(i);
+         if (cmd->name == NULL) continue;
+        _serial->print(F("  "));
+        _serial->print(cmd->name);
         /* Basic padding attempt */
-        int nameLen = (int)strlen(_commands[i].name);
+        int nameLen = (int)strlen(cmd->name);
         int padding = 15 - nameLen;
         if (padding < 1) padding = 1;
         for (int pad = 0; pad < padding; pad++) {
-             _serial.print(' ');
+             _serial->print(' ');
         }
-        _serial.print(F("- "));
-        _serial.print(_commands[i].help_text ? _commands[i].help_text : "");
-        _serial.print(F(" (max args: "));
-        _serial.print(_commands[i].max_args);
-        _serial.println(F(")"));
+        _serial->print(F("- "));
+        _serial->print(cmd->help_text ? cmd->help_text : "");
+        _serial->print(F(" (max args: "));
+        _serial->print(cmd->max_args);
+        _serial->println(F(")"));
     }
+#endif
+    _unpinTable();
 }
@@ -20,15 +20,142 @@
 
 #include <Arduino.h>
 #include <stddef.h> // For size_t
+#include "CLIJson.h"
+#include "CLICbor.h"
+
+/* Linux host builds (e.g., EpoxyDuino) get the host-only front-ends */
+#if defined(__linux__) && !defined(CLI_NO_HOST_SERVER)
+#define CLI_HOST_SERVER 1
+#endif
+
+/*
+ * Interactive features that units driven only by a host program can compile out.
+ * Define them for the whole build (library and sketch), e.g. in build_flags.
+ * CLI_MINIMAL selects all of them: lines are then just collected until CR or LF.
+ */
+#ifdef CLI_MINIMAL
+#ifndef CLI_NO_ECHO
+#define CLI_NO_ECHO 1               /**< Don't echo typed characters, backspace or ^C. */
+#endif
+#ifndef CLI_NO_TAB_COMPLETION
+#define CLI_NO_TAB_COMPLETION 1     /**< Tab is ignored. */
+#endif
+#ifndef CLI_NO_HELP
+#define CLI_NO_HELP 1               /**< printHelp() lists names only; CLI_HELP() text is dropped. */
+#endif
+#ifndef CLI_NO_EDITING
+#define CLI_NO_EDITING 1            /**< Backspace, DEL and history keys are ignored. */
+#endif
+#endif
+
+/**
+ * @brief Help text of a table entry; NULL (and not linked) when built with CLI_NO_HELP.
+ * Example: {"led", led_handler, 1, CLI_HELP("Turn the LED on or off"), 0, NULL}
+ */
+#ifdef CLI_NO_HELP
+#define CLI_HELP(text) NULL
+#else
+#define CLI_HELP(text) text
+#endif
 
 /* Default configuration values */
 #define CLI_DEFAULT_MAX_LINE_LEN 64 /**< Default maximum input line length. */
 #define CLI_DEFAULT_MAX_ARGS 8      /**< Default maximum number of arguments (excluding command name). */
 #define CLI_DEFAULT_PROMPT "> "     /**< Default command prompt string. */
 #define CLI_MAX_PROMPT_LEN 18       /**< Maximum allowed length for the prompt string. */
+#define CLI_DEFAULT_CHECKPOINT_INTERVAL 32 /**< Default number of checkpoint() calls between input checks. */
+#define CLI_CTRL_C 3                /**< Ctrl+C (End of Text) character code. */
+#define CLI_CTRL_HUMAN 1            /**< Ctrl+A: leave machine mode. */
+#define CLI_CTRL_MACHINE 2          /**< Ctrl+B: enter machine mode. */
+#define CLI_CTRL_BINARY 14          /**< Ctrl+N (Shift Out): enter binary mode (machine mode only). */
+#define CLI_CTRL_R 18               /**< Ctrl+R: reverse history search. */
+#define CLI_CTRL_ESC 27             /**< Escape: starts a terminal key sequence (e.g., arrow keys). */
+#define CLI_MAX_INDEXED_COMMANDS 255 /**< Larger command tables fall back to a linear search. */
+#ifndef CLI_INJECT_LINE_LEN
+#define CLI_INJECT_LINE_LEN CLI_DEFAULT_MAX_LINE_LEN /**< Line capacity of one injection queue slot. */
+#endif
+#define CLI_MAX_INJECT_SLOTS 0x4000 /**< Upper bound on injection queue slots. */
+#ifndef CLI_PREPARED_MAX_ARGS
+#define CLI_PREPARED_MAX_ARGS 4     /**< Maximum arguments (excluding command name) of a prepared command. */
+#endif
+#ifndef CLI_PREPARED_LINE_LEN
+#define CLI_PREPARED_LINE_LEN 32    /**< Line capacity of a prepared command. */
+#endif
+
+#ifndef CLI_SCRIPT_MAX_ARGS
+#define CLI_SCRIPT_MAX_ARGS CLI_DEFAULT_MAX_ARGS /**< Maximum arguments (excluding command name) per script line. */
+#endif
+#define CLI_SCRIPT_VERSION 1        /**< Compiled script format version. */
+#define CLI_SCRIPT_HEADER_LEN 10    /**< "CLS", version, table hash (4), record count (2). */
+
+/* compileScript() / runScript() errors */
+#define CLI_SCRIPT_ERR_FORMAT -1    /**< Not a compiled script, unknown version, or corrupt. */
+#define CLI_SCRIPT_ERR_TABLE -2     /**< Compiled against a different command table. */
+#define CLI_SCRIPT_ERR_SPACE -3     /**< Output buffer too small. */
+#define CLI_SCRIPT_ERR_LINE -4      /**< A script line failed validation. */
+
+/* runFile() flags (host builds only) */
+#define CLI_RUNFILE_STOP_ON_ERROR 0x01 /**< Stop at the first line that fails. */
+#define CLI_RUNFILE_TIMINGS 0x02    /**< Add per-command timings to the report. */
+#define CLI_RUNFILE_ERR_OPEN -1     /**< runFile(): the file cannot be opened or mapped. */
+
+/* prepare() results */
+#define CLI_PREPARE_OK 0            /**< Resolved and validated. */
+#define CLI_PREPARE_EMPTY 1         /**< Line has no command. */
+#define CLI_PREPARE_UNKNOWN 2       /**< No command matches. */
+#define CLI_PREPARE_AMBIGUOUS 3     /**< Several commands match the prefix. */
+#define CLI_PREPARE_TOO_MANY_ARGS 4 /**< More arguments than the command (or CLI_PREPARED_MAX_ARGS) accepts. */
+#define CLI_PREPARE_TOO_LONG 5      /**< Line does not fit CLI_PREPARED_LINE_LEN. */
+#define CLI_PREPARE_REMOVED 6       /**< execute(): the command is no longer in the registry. */
+#define CLI_PREPARE_OPERATOR 7      /**< Line holds ';', '&&', '||' or '|'. */
+
+/* CLI_Command_t flags */
+#define CLI_FLAG_THREAD_SAFE 0x01   /**< Handler may run concurrently with other commands (host dispatcher). */
+#define CLI_FLAG_STATUS 0x02        /**< func is a cli_status_handler_t (see CLI_STATUS_COMMAND()). */
+
+/* Command status */
+#define CLI_STATUS_OK 0             /**< Command succeeded (also reported for void handlers). */
+#define CLI_STATUS_FAIL 1           /**< Command failed, or the line did not resolve to a command. */
+
+/* Result codes of machine mode response frames */
+#define CLI_RESULT_OK 0             /**< Command ran and succeeded. */
+#define CLI_RESULT_UNKNOWN 1        /**< No command matches. */
+#define CLI_RESULT_AMBIGUOUS 2      /**< Several commands match the prefix. */
+#define CLI_RESULT_TOO_MANY_ARGS 3  /**< More arguments than the command accepts. */
+#define CLI_RESULT_FAILED 4         /**< Handler returned a failure status, or a pipeline failed. */
+#define CLI_RESULT_OVERFLOW 5       /**< Output did not fit the response buffer and was truncated. */
+#define CLI_RESULT_CANCELLED 6      /**< Cancelled with Ctrl+C or cancel(). */
+#define CLI_RESULT_SKIPPED 7        /**< Not run because of '&&' / '||'. */
+#define CLI_RESULT_BAD_FRAME 8      /**< Binary packet is damaged, or a line fails its checksum. */
 
-/* Forward declaration */
+/* Line checksums (setLineChecksum()) */
+#define CLI_CHECKSUM_NONE 0         /**< Lines are not checked. */
+#define CLI_CHECKSUM_NMEA 1         /**< "*XX" suffix: XOR of the line's bytes, as in NMEA 0183. */
+#define CLI_CHECKSUM_CRC8 2         /**< "*XX" suffix: CRC-8/SMBUS (poly 0x07) of the line's bytes. */
+
+/* Output formats of the library's own messages (setJsonMode(), setCborMode()) */
+#define CLI_FORMAT_TEXT 0           /**< Text for people. */
+#define CLI_FORMAT_JSON 1           /**< One JSON document per line. */
+#define CLI_FORMAT_CBOR 2           /**< CBOR items, for machine mode or binary transport. */
+
+/* Binary transport (see CLIBinary.cpp) */
+#define CLI_BINARY_EXIT 0xFFFF      /**< Command index of the packet that returns to text mode. */
+#define CLI_BINARY_OVERHEAD 5       /**< Reply bytes besides the output: seq, result, status, CRC-16. */
+
+/**
+ * @brief Table entry for a cli_status_handler_t.
+ * Example: CLI_STATUS_COMMAND("apply", apply_handler, 0, "Apply the configuration")
+ * The conditional makes the compiler check func's type; void (*)(void) is the
+ * generic function pointer type the table stores it through.
+ */
+#define CLI_STATUS_COMMAND(name, func, max_args, help_text) \
+    {name, (cli_command_handler_t)(void (*)(void))(true ? (func) : (cli_status_handler_t)NULL), \
+     max_args, CLI_HELP(help_text), CLI_FLAG_STATUS, NULL}
+
+/* Forward declarations */
 class ArduinoCLI;
+class CLICommandRegistry;
+class CLIScheduler;
 
 /**
  * @brief Function pointer type for command handler functions.
@@ -38,6 +165,13 @@ class ArduinoCLI;
  */
 typedef void (*cli_command_handler_t)(ArduinoCLI* cli, int argc, char *argv[]);
 
+/**
+ * @brief Handler variant that reports success or failure, for '&&' / '||' chains.
+ * Declare its table entry with CLI_STATUS_COMMAND().
+ * @return CLI_STATUS_OK (0) on success, any other value on failure.
+ */
+typedef int (*cli_status_handler_t)(ArduinoCLI* cli, int argc, char *argv[]);
+
 /**
  * @brief Structure defining a command for the CLI.
  */
@@ -46,8 +180,189 @@ typedef struct {
     cli_command_handler_t func;  /**< Function pointer to the command handler. */
     int max_args;                /**< Maximum number of user-provided arguments allowed (0 for none). */
     const char *help_text;       /**< Brief description of the command for help output. */
+    uint8_t flags;               /**< CLI_FLAG_* bits (0 if omitted from the initializer). */
+    void *ctx;                   /**< Handler context returned by ArduinoCLI::getContext() (NULL if omitted). */
 } CLI_Command_t;
 
+/**
+ * @brief Calls a command's handler, whichever handler type it has.
+ * getContext() returns the command's ctx while the handler runs.
+ * @return The handler's status, or CLI_STATUS_OK for a void handler.
+ */
+inline int cli_invoke(const CLI_Command_t* cmd, ArduinoCLI* cli, int argc, char *argv[]);
+
+/**
+ * @brief Hook that may take over execution of a resolved, validated command.
+ * Used by dispatchers that run handlers on another thread or task.
+ * @param ctx Context pointer given to setDispatchHook().
+ * @param cli The CLI instance that parsed the command.
+ * @param cmd The resolved command.
+ * @param argc Argument count (including command name).
+ * @param argv Argument vector; stays valid until completeDispatch() is called.
+ * @return true if the command was deferred (completeDispatch() must follow), false to run it inline.
+ */
+typedef bool (*cli_dispatch_hook_t)(void* ctx, ArduinoCLI* cli, const CLI_Command_t* cmd, int argc, char *argv[]);
+
+/**
+ * @class CLICommandTable
+ * @brief Immutable command table plus a sorted lookup index.
+ *
+ * The index holds command positions sorted by name, so commands sharing a prefix are
+ * contiguous and lookups are a binary search instead of a scan of the whole table.
+ * One table can be shared by any number of ArduinoCLI sessions.
+ */
+class CLICommandTable {
+public:
+    /**
+     * @brief Builds the lookup index for a command array.
+     * @param commands Pointer to an array of CLI_Command_t structures (must outlive the table).
+     * @param commandCount The number of commands in the commands array.
+     * @param indexStorage Optional storage for commandCount index bytes; allocated with malloc if NULL.
+     *        If no index can be built, lookups fall back to a linear search.
+     */
+    CLICommandTable(const CLI_Command_t commands[], size_t commandCount, uint8_t* indexStorage = nullptr);
+
+    /**
+     * @brief Frees the index if it was allocated by the table.
+     */
+    ~CLICommandTable();
+
+    /**
+     * @brief Gets the number of entries in the command array.
+     * @return The command count.
+     */
+    size_t count() const;
+
+    /**
+     * @brief Gets a command by its position in the original array.
+     * @param i Position (0 .. count()-1).
+     * @return Pointer to the command, or NULL if out of range.
+     */
+    const CLI_Command_t* command(size_t i) const;
+
+    /**
+     * @brief Finds a command matching the given prefix. Exact matches win.
+     * @param[in] prefix The command name prefix to search for.
+     * @param[out] matchCount Optional; receives the number of commands starting with prefix.
+     * @return Pointer to the matched command, or NULL if not found or ambiguous.
+     */
+    const CLI_Command_t* find(const char* prefix, int* matchCount = nullptr) const;
+
+    /**
+     * @brief Collects the names of all commands starting with prefix.
+     * @param[in] prefix The command name prefix.
+     * @param[out] names Array receiving up to maxNames name pointers.
+     * @param[in] maxNames Capacity of the names array.
+     * @return The number of names stored.
+     */
+    int collectMatches(const char* prefix, const char* names[], int maxNames) const;
+
+    /**
+     * @brief Computes a 32-bit FNV-1a hash of the command names, argument limits and order.
+     * Compiled scripts are only accepted by a table with the same hash.
+     * @return The table hash.
+     */
+    uint32_t hash() const;
+
+private:
+    const CLI_Command_t* _commands; /**< Pointer to the user-provided command array. */
+    size_t _commandCount;       /**< Number of commands in the _commands array. */
+    uint8_t* _index;            /**< Command positions sorted by name, or NULL for linear search. */
+    size_t _indexCount;         /**< Number of named (indexed) commands. */
+    bool _ownsIndex;            /**< _index was allocated with malloc. */
+
+    /**
+     * @brief Finds the first index slot whose name is not less than prefix.
+     * @private
+     */
+    size_t _lowerBound(const char* prefix) const;
+};
+
+/**
+ * @brief One slot of the command injection queue (see ArduinoCLI::setInjectQueue()).
+ * Contents are managed by the library.
+ */
+typedef struct {
+    volatile uint16_t seq;           /**< Slot sequence number (producer/consumer handshake). */
+    Print* sink;                     /**< Output destination for the command, or NULL. */
+    char line[CLI_INJECT_LINE_LEN];  /**< Copied command line. */
+} CLIInjectSlot;
+
+/**
+ * @brief A command line parsed and resolved once by ArduinoCLI::prepare(), run by execute().
+ * Storage is provided by the caller; contents are managed by the library. Handlers run
+ * from it must not modify their argv strings, as they are reused on the next execute().
+ */
+typedef struct {
+    const CLI_Command_t* cmd;       /**< Resolved command, or NULL if status is not CLI_PREPARE_OK. */
+    const char* name;               /**< Full command name (re-resolved when a registry is used). */
+    uint8_t status;                 /**< CLI_PREPARE_* validation result. */
+    uint8_t argc;                   /**< Argument count (including command name). */
+    char* argv[CLI_PREPARED_MAX_ARGS + 2]; /**< Argument vector into line (NULL-terminated). */
+    char line[CLI_PREPARED_LINE_LEN]; /**< Private, tokenized copy of the line. */
+} CLIPreparedCommand;
+
+/**
+ * @class CLIPrintStream
+ * @brief Stream forwarding output to a Print (or discarding output if NULL) and input
+ * from an optional Stream. Used as the console of injected commands and of pipeline
+ * stages, so getSerial() keeps working in handlers.
+ */
+class CLIPrintStream : public Stream {
+public:
+    explicit CLIPrintStream(Print* target, Stream* source = nullptr) : _target(target), _source(source) {}
+
+    int available() override { return _source ? _source->available() : 0; }
+    int read() override { return _source ? _source->read() : -1; }
+    int peek() override { return _source ? _source->peek() : -1; }
+    size_t write(uint8_t c) override { return _target ? _target->write(c) : 1; }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        return _target ? _target->write(buffer, size) : size;
+    }
+    using Print::write;
+
+private:
+    Print* _target;             /**< Destination, or NULL to discard. */
+    Stream* _source;            /**< Input, or NULL for none. */
+};
+
+/**
+ * @brief Per-Stream line editing state: the Stream, line buffer, argv, prompt and editor.
+ * Every ArduinoCLI holds one. CLISessionManager keeps one per attached Stream and loads
+ * it into a single shared ArduinoCLI while that Stream is served; everything else (table,
+ * registry, modes, writers, queues) belongs to the shared instance. Contents are managed
+ * by the library.
+ */
+struct CLISessionState {
+    Stream* _serial;            /**< Pointer to the Stream object (e.g., Serial); NULL for an unbound session. */
+    bool _isRunning;            /**< Flag indicating if the CLI should process input. */
+
+    char* _lineBuffer;          /**< Input line buffer (allocated or caller-provided). */
+    size_t _maxLineLen;         /**< Maximum size of the _lineBuffer. */
+    size_t _bufferPos;          /**< Current position (index) in the _lineBuffer. */
+
+    char** _argv;               /**< Argument vector (array of char*, allocated or caller-provided). */
+    size_t _maxArgs;            /**< Maximum size of the _argv array. */
+
+    char _prompt[CLI_MAX_PROMPT_LEN]; /**< The current command prompt string. */
+    char _skipChar;             /**< Second half of a CRLF/LFCR pair to swallow, or 0. */
+
+#ifndef CLI_NO_EDITING
+    size_t _historyCursor;      /**< Entry shown by the arrow keys, or the history size for none. */
+    uint16_t _historySeen;      /**< History additions the cursor is based on (see _loadSession()). */
+    uint8_t _escape;            /**< Escape sequence state: 0 none, 1 after ESC, 2 in a CSI. */
+    bool _searching;            /**< Ctrl+R search in progress; the match is in the line buffer. */
+    uint8_t _searchOff;         /**< Search pattern: offset in the match. */
+    uint8_t _searchLen;         /**< Search pattern: length. */
+#endif
+
+    /**
+     * @brief Creates the state of a new session: not running, no buffers, default prompt.
+     * @param serial The session's Stream, or NULL.
+     */
+    explicit CLISessionState(Stream* serial = nullptr);
+};
+
 /**
  * @class ArduinoCLI
  * @brief Provides a command-line interface framework for Arduino using Stream objects.
@@ -56,7 +371,7 @@ typedef struct {
  * (including partial matches and tab completion attempts), validating argument counts,
  * and executing corresponding handler functions.
  */
-class ArduinoCLI {
+class ArduinoCLI : private CLISessionState {
 public:
     /**
      * @brief Constructor for the ArduinoCLI class.
@@ -66,6 +381,28 @@ public:
      */
     ArduinoCLI(Stream& serialPort, const CLI_Command_t commands[], size_t commandCount);
 
+    /**
+     * @brief Constructor using a shared, prebuilt command table.
+     * @param serialPort Reference to the Stream object used for input/output (e.g., Serial).
+     * @param table Command table and lookup index (must outlive the CLI instance).
+     */
+    ArduinoCLI(Stream& serialPort, const CLICommandTable& table);
+
+    /**
+     * @brief Destructor. Frees buffers allocated by the library.
+     */
+    ~ArduinoCLI();
+
+    /**
+     * @brief Uses caller-provided storage for the line buffer and argv array instead of malloc.
+     * Any buffers previously allocated by the library are freed.
+     * @param lineBuffer Storage for the input line.
+     * @param lineLen Size of lineBuffer in bytes (must be > 1).
+     * @param argv Storage for the argument vector.
+     * @param argvLen Number of entries in argv, including the command name and NULL terminator (must be > 1).
+     */
+    void setBuffers(char* lineBuffer, size_t lineLen, char** argv, size_t argvLen);
+
     /**
      * @brief Sets the maximum length of the internal line buffer.
      * @param len The desired maximum length (must be > 0).
@@ -88,7 +425,7 @@ public:
 
     /**
      * @brief Starts or restarts CLI processing.
-     * Sets the running flag and prints the initial command prompt.
+     * Sets the running flag, clears any partial input line and prints the initial command prompt.
      */
     void start();
 
@@ -100,6 +437,14 @@ public:
      */
     void poll();
 
+    /**
+     * @brief Polls the associated Stream, consuming at most maxBytes input characters.
+     * Lets several CLI instances share the CPU fairly.
+     * @param maxBytes Maximum number of characters to read in this call.
+     * @return The number of characters read.
+     */
+    size_t poll(size_t maxBytes);
+
     /**
      * @brief Processes a single, complete line of input.
      * Parses the line into command and arguments and executes the matched command.
@@ -108,6 +453,64 @@ public:
      */
     void processInput(char* line);
 
+    /**
+     * @brief Parses, resolves and validates a command line once for repeated execute() calls.
+     * The line holds a single command: ';', '&&', '||' or '|' fail with CLI_PREPARE_OPERATOR.
+     * @param line The command line (copied; not modified).
+     * @param[out] prepared Caller-provided handle receiving the result.
+     * @return CLI_PREPARE_OK, or a CLI_PREPARE_* error (also stored in prepared->status).
+     */
+    uint8_t prepare(const char* line, CLIPreparedCommand* prepared);
+
+    /**
+     * @brief Runs a prepared command directly, without tokenizing or searching the table.
+     * Output goes to the CLI's Stream; no prompt is printed.
+     * @param prepared A handle filled by prepare().
+     * With a registry, the command is looked up again by its exact name; if it is gone (or
+     * no longer takes the arguments), the handle's status becomes CLI_PREPARE_REMOVED.
+     * @return false if the handle is not valid (or its command was removed from the registry).
+     */
+    bool execute(CLIPreparedCommand* prepared);
+
+    /**
+     * @brief Compiles a text script (one command per line, '#' comments) against the command table.
+     * Every line is resolved and validated once; operators (';', '&&', '||', '|') are errors.
+     * See CLIScript.cpp for the format.
+     * @param text The script, NUL-terminated; lines end with LF or CRLF.
+     * @param out Buffer receiving the compiled script.
+     * @param outSize Size of out.
+     * @param errors Optional destination for error messages (with line numbers).
+     * @return Compiled size in bytes, or a CLI_SCRIPT_ERR_* code.
+     */
+    long compileScript(const char* text, uint8_t* out, size_t outSize, Print* errors = nullptr);
+
+    /**
+     * @brief Runs a compiled script straight from a buffer (RAM, flash mapping or mmap).
+     * The whole script is checked first, so a corrupt script runs nothing. Each command's
+     * arguments are copied to a stack buffer of CLI_SCRIPT_LINE_LEN bytes, so handlers may
+     * modify their argument strings as usual (argv[0] is the command's name, as with binary
+     * requests). Stops early if a command is cancelled.
+     * @param script The compiled script.
+     * @param len Its length in bytes.
+     * @return Number of commands executed, or a CLI_SCRIPT_ERR_* code.
+     */
+    long runScript(const uint8_t* script, size_t len);
+
+#ifdef CLI_HOST_SERVER
+    /**
+     * @brief Runs a text command file through mmap (host builds only).
+     * Each line is copied into a private buffer of the line buffer's size and parsed there,
+     * so it may be called from a handler: the caller's argv and the rest of a chained line
+     * are left alone. Blank lines and '#' comments are skipped, and a line holding an operator
+     * (';', '&&', '||', '|') fails, since each line is one command. Ctrl+C stops the run.
+     * @param path File name.
+     * @param flags CLI_RUNFILE_* bits.
+     * @param report Optional destination for a summary (lines/sec, per-command timings).
+     * @return Number of lines that failed (0 if all ran), or CLI_RUNFILE_ERR_OPEN.
+     */
+    long runFile(const char* path, uint8_t flags = CLI_RUNFILE_STOP_ON_ERROR, Print* report = nullptr);
+#endif
+
     /**
      * @brief Checks if the CLI is currently in a running state.
      * The state is set to false by the stop() method (typically called by an 'exit' command).
@@ -126,6 +529,7 @@ public:
      * @brief Helper function to print the list of available commands.
      * Iterates through the registered command table and prints names, help text, and max arguments.
      * Designed to be called from a user-defined 'help' command handler.
+     * Built with CLI_NO_HELP, only the command names are listed.
      */
     void printHelp();
 
@@ -135,21 +539,404 @@ public:
      */
     void stop();
 
+    /**
+     * @brief Returns the session to its just-constructed state, keeping the Stream, command
+     * table, registry and line/argv buffers.
+     * Stops processing, drops the partial line and restores the default prompt, output format,
+     * checksum and checkpoint interval. Machine and binary mode are left, and the history,
+     * line queue, injection queue, scheduler, pipe, response and binary buffers and the
+     * dispatch hook are detached. Used by CLIHostServer before a connection's session serves
+     * another client; must not be called while a command or dispatch is in progress.
+     */
+    void resetSession();
+
+    /**
+     * @brief Checks whether the running command has been cancelled with Ctrl+C.
+     * Peeks at the head of the input stream; a pending Ctrl+C is consumed and latched,
+     * any other typed-ahead byte is left in the stream untouched.
+     * The cancellation flag is cleared before each command is executed.
+     * @return true if Ctrl+C was received (or cancel() was called) since the command started.
+     */
+    bool isCancelled();
+
+    /**
+     * @brief Cheap cancellation check for use in a command handler's inner loop.
+     * Only looks at the input stream once every setCheckpointInterval() calls,
+     * otherwise just returns the latched cancellation flag.
+     * @return true if the running command has been cancelled.
+     */
+    bool checkpoint();
+
+    /**
+     * @brief Requests cancellation of the running command.
+     * The handler observes it through isCancelled() or checkpoint().
+     */
+    void cancel();
+
+    /**
+     * @brief Sets how many checkpoint() calls pass between input stream checks.
+     * @param interval Number of calls (must be > 0).
+     */
+    void setCheckpointInterval(uint16_t interval);
+
+    /**
+     * @brief Enables the type-ahead line queue using caller-provided storage.
+     * While a command runs, bytes drained by checkpoint()/isCancelled() (or pushed with
+     * feedInput()) are collected into this arena as complete lines. poll() executes the
+     * queued lines back-to-back, without intermediate prompts, once the command returns.
+     * Not safe while a producer may call feedInput().
+     * @param arena Byte arena for queued lines (NULL disables the queue).
+     * @param size Size of the arena in bytes. Each queued line costs its length + 1.
+     */
+    void setLineQueue(char* arena, size_t size);
+
+    /**
+     * @brief Enables command history using caller-provided storage.
+     * Typed lines are kept in the arena, the oldest evicted first; a line equal to the
+     * previous one is not stored again. Up and down arrows recall them into the line buffer,
+     * and Ctrl+R searches them.
+     * @param arena Byte arena for history (NULL disables history).
+     * @param size Size of the arena in bytes. Each line costs its length + 2; longer than
+     * 255 characters are not kept.
+     * Does nothing when built with CLI_NO_EDITING.
+     */
+    void setHistoryBuffer(char* arena, size_t size);
+
+    /**
+     * @brief Pushes one input byte into the type-ahead line queue.
+     * Safe to call from a single producer context (e.g., a UART receive ISR, a task or a
+     * thread on another core) while poll() consumes the queue. That producer should then
+     * be the only source of input: bytes on the Stream are fed from poll()'s context.
+     * Handles line endings, backspace and Ctrl+C; no echo.
+     * @param c The received character.
+     * @return false if the queue is disabled or full and the byte was dropped.
+     */
+    bool feedInput(char c);
+
+    /**
+     * @brief Gets the number of complete lines waiting in the type-ahead queue.
+     * @return Number of queued lines.
+     */
+    size_t queuedLines() const;
+
+    /**
+     * @brief Enables the command injection queue using caller-provided slots.
+     * Not safe while producers may call inject().
+     * @param slots Slot array (NULL disables the queue).
+     * @param count Number of slots; rounded down to a power of two (max CLI_MAX_INJECT_SLOTS).
+     */
+    void setInjectQueue(CLIInjectSlot slots[], size_t count);
+
+    /**
+     * @brief Queues a command line for execution by poll(). Lock-free; callable from any
+     * number of other tasks, threads or ISRs at once.
+     * The line is copied. poll() runs it inline between input bytes with the command's output
+     * (including error messages) sent to sink instead of the console, unframed even in
+     * machine mode.
+     * @param line The command line (shorter than CLI_INJECT_LINE_LEN).
+     * @param sink Output destination (must stay valid until the command ran), or NULL to discard.
+     * @return false if the queue is disabled or full, or the line is too long.
+     */
+    bool inject(const char* line, Print* sink = nullptr);
+
+    /**
+     * @brief Installs a hook that may defer command execution (e.g., to a worker thread).
+     * While a deferred command is pending, poll() reads no input and the line buffer and
+     * argv must not be touched by anyone but the handler.
+     * @param hook The hook, or NULL to always execute inline.
+     * @param ctx Context pointer passed to the hook.
+     */
+    void setDispatchHook(cli_dispatch_hook_t hook, void* ctx);
+
+    /**
+     * @brief Finishes a command deferred by the dispatch hook.
+     * Runs the rest of a chained line, prints the prompt and resumes processing of
+     * already received input; any of these may defer the next command.
+     * @param status The handler's status (see cli_invoke()), for '&&' / '||'.
+     */
+    void completeDispatch(int status = CLI_STATUS_OK);
+
+    /**
+     * @brief Abandons a command deferred by the dispatch hook.
+     * For dispatchers shutting down: the rest of the line is dropped, the command table is
+     * unpinned and no prompt is printed. Must not be called while the handler still runs.
+     */
+    void cancelDispatch();
+
+    /**
+     * @brief Checks whether a command deferred by the dispatch hook is still running.
+     * @return true if completeDispatch() has not been called yet.
+     */
+    bool isDispatchPending() const;
+
+    /**
+     * @brief Gets the context pointer of the command whose handler is running.
+     * Lets one handler serve several objects (see CLI_METHOD_COMMAND()).
+     * @return The command's ctx, or NULL outside a handler.
+     */
+    void* getContext() const;
+
+    /**
+     * @brief Gets the status of the last command run from a line.
+     * @return CLI_STATUS_OK, CLI_STATUS_FAIL or a status handler's return value.
+     */
+    int getStatus() const;
+
+    /**
+     * @brief Resolves commands through a runtime registry instead of the fixed table.
+     * Each command and tab completion sees one consistent snapshot, even while another
+     * thread adds or removes commands. Claims a reader slot from the registry.
+     * Must not be called from within a command handler.
+     * @param registry The registry (must outlive the CLI instance), or NULL to go back to the fixed table.
+     * @return false if the registry has no free reader slot.
+     */
+    bool setCommandRegistry(CLICommandRegistry* registry);
+
+    /**
+     * @brief Provides the buffer that carries output between the commands of a pipeline
+     * ('dump 0x1000 256 | grep ff'). Stages run one after another, each reading the
+     * previous one's output through getSerial(). Lines with more than one '|' split the
+     * buffer in two. A stage whose output does not fit is cancelled and the line fails.
+     * @param buffer Caller-provided storage, or NULL to disable pipes.
+     * @param size Size of buffer in bytes.
+     */
+    void setPipeBuffer(char* buffer, size_t size);
+
+    /**
+     * @brief Provides the buffer that collects a command's output in machine mode.
+     * Output that does not fit cancels the command and is reported as CLI_RESULT_OVERFLOW.
+     * @param buffer Caller-provided storage, or NULL (machine mode is then turned off).
+     * @param size Size of buffer in bytes.
+     */
+    void setResponseBuffer(char* buffer, size_t size);
+
+    /**
+     * @brief Turns machine mode on or off (also Ctrl+B / Ctrl+A on the input).
+     * In machine mode there is no echo and no prompt, and each command's output is sent as
+     * one frame: "!<seq> <result> <length>\n" followed by length bytes of output.
+     * seq numbers frames from 0 (Ctrl+B answers with an empty frame), result is a
+     * CLI_RESULT_* code. Handlers run inline.
+     * A line may start with a "#id" tag, which is added to each of its frames as " #id"
+     * (a tagged line without a command gets one empty frame). Hosts can then send many
+     * lines without waiting; with setLineQueue(), input that arrives while a command runs
+     * or its frame is sent is queued instead of overflowing the receive buffer.
+     * @param enable true for machine mode, false for the interactive console.
+     * @return false if machine mode was requested without a response buffer.
+     */
+    bool setMachineMode(bool enable);
+
+    /**
+     * @brief Checks whether the session is in machine mode.
+     * @return true if responses are framed.
+     */
+    bool isMachineMode() const;
+
+    /**
+     * @brief Gets the session's JSON writer, bound to the current output (see getSerial()).
+     * Example: cli->json().beginObject().key("temp").value(23.5).endObject();
+     * @return The writer.
+     */
+    CLIJsonWriter& json();
+
+    /**
+     * @brief Selects JSON output for printHelp(), error messages and the scheduler's job
+     * list, instead of text. Handlers can check isJsonMode() to do the same.
+     * @param enable true for JSON, false for text.
+     */
+    void setJsonMode(bool enable);
+
+    /**
+     * @brief Checks whether the session produces JSON.
+     * @return true in JSON mode.
+     */
+    bool isJsonMode() const;
+
+    /**
+     * @brief Gets the session's CBOR encoder, bound to the current output (see getSerial()).
+     * Example: cli->cbor().beginObject(1).key("temp").value(23.5f);
+     * @return The encoder.
+     */
+    CLICborWriter& cbor();
+
+    /**
+     * @brief Selects CBOR output for printHelp(), error messages and the scheduler's job
+     * list, with the same structure as in JSON mode. Meant for machine mode or binary
+     * transport, where replies carry their length. Handlers can check isCborMode().
+     * @param enable true for CBOR, false for text.
+     */
+    void setCborMode(bool enable);
+
+    /**
+     * @brief Checks whether the session produces CBOR.
+     * @return true in CBOR mode.
+     */
+    bool isCborMode() const;
+
+    /**
+     * @brief Requires a checksum on each line received, for noisy links (e.g., long RS-485 runs).
+     * Lines end with "*XX", two hex digits over all bytes before the '*'. A line that fails
+     * is not executed; it is answered with "NAK" (or a CLI_RESULT_BAD_FRAME frame in machine
+     * mode). Machine mode frames then end with "*XX\n" over the header and output.
+     * Lines run by handlers or inject() are not checked.
+     * @param mode CLI_CHECKSUM_NONE, CLI_CHECKSUM_NMEA or CLI_CHECKSUM_CRC8.
+     */
+    void setLineChecksum(uint8_t mode);
+
+    /**
+     * @brief Provides the buffer that receives decoded binary packets.
+     * @param buffer Caller-provided storage (largest packet), or NULL (binary mode is then turned off).
+     * @param size Size of buffer in bytes.
+     */
+    void setBinaryBuffer(uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Switches between the text line discipline and COBS-framed binary packets
+     * (also Ctrl+N on the input in machine mode, and a CLI_BINARY_EXIT packet). See CLIBinary.cpp
+     * for the format.
+     * Replies are collected in the response buffer (setResponseBuffer()); output beyond
+     * its size minus CLI_BINARY_OVERHEAD bytes is truncated.
+     * @param enable true for binary packets, false for text lines.
+     * @return false if binary mode was requested without a binary and a response buffer.
+     */
+    bool setBinaryMode(bool enable);
+
+    /**
+     * @brief Checks whether the session reads binary packets.
+     * @return true in binary mode.
+     */
+    bool isBinaryMode() const;
+
+    /**
+     * @brief Attaches a scheduler for periodic commands ('every', 'watch'); poll() services it.
+     * @param scheduler The scheduler (one per session), or NULL to detach.
+     */
+    void setScheduler(CLIScheduler* scheduler);
+
+    /**
+     * @brief Gets the attached scheduler.
+     * @return The scheduler, or NULL.
+     */
+    CLIScheduler* getScheduler();
 
 private:
-    Stream& _serial;             /**< Reference to the Stream object (e.g., Serial). */
-    const CLI_Command_t* _commands; /**< Pointer to the user-provided command array. */
-    size_t _commandCount;       /**< Number of commands in the _commands array. */
-    bool _isRunning;            /**< Flag indicating if the CLI should process input. */
+    template <size_t, size_t, size_t> friend class CLISessionManager;
+    friend class CLIScheduler;
+    friend int cli_invoke(const CLI_Command_t* cmd, ArduinoCLI* cli, int argc, char *argv[]);
+    template <class> friend class ArduinoCLIT;
 
-    char* _lineBuffer;          /**< Dynamically allocated input line buffer. */
-    size_t _maxLineLen;         /**< Maximum size of the _lineBuffer. */
-    size_t _bufferPos;          /**< Current position (index) in the _lineBuffer. */
+    /**
+     * @brief Creates the unbound, shared instance of a CLISessionManager.
+     * @private
+     */
+    ArduinoCLI();
 
-    char** _argv;               /**< Dynamically allocated argument vector (array of char*). */
-    size_t _maxArgs;            /**< Maximum size of the _argv array. */
+    /**
+     * @brief Makes a pooled session's state current (CLISessionManager).
+     * Drops its history position if other sessions added lines since it was saved.
+     * @private
+     */
+    void _loadSession(const CLISessionState& session);
 
-    char _prompt[CLI_MAX_PROMPT_LEN]; /**< The current command prompt string. */
+    /**
+     * @brief Stores the current session state back into its pool entry.
+     * @private
+     */
+    void _saveSession(CLISessionState& session) const;
+
+    /**
+     * @brief Common member initialization shared by the public constructors.
+     * @private
+     */
+    ArduinoCLI(Stream* serialPort, const CLI_Command_t commands[], size_t commandCount);
+
+    CLICommandTable _ownTable;  /**< Table built from the array passed to the constructor, if any. */
+    const CLICommandTable* _table; /**< Command table in use (own or shared). */
+    bool _ownsBuffers;          /**< Buffers were allocated with malloc and must be freed. */
+
+    volatile bool _cancelled;   /**< Latched Ctrl+C / cancel() request for the running command. */
+    uint16_t _checkpointInterval; /**< checkpoint() calls between input stream checks. */
+    uint16_t _checkpointCountdown; /**< checkpoint() calls remaining until the next check. */
+
+    char* _queue;               /**< Caller-provided type-ahead line arena (ring of NUL-terminated lines). */
+    size_t _queueSize;          /**< Size of the _queue arena. */
+    volatile size_t _queueHead; /**< Consumer: start of the oldest queued line. */
+    volatile size_t _queueWrite; /**< Producer: next write position (end of the partial line). */
+    size_t _queuePartialLen;    /**< Producer: length of the line currently being collected. */
+    volatile size_t _queueCommitted; /**< Producer: count of lines committed (wraps). */
+    volatile size_t _queueConsumed;  /**< Consumer: count of lines executed (wraps). */
+    bool _queueStreamPartial;   /**< Partial line was drained from _serial (restore it after the command). */
+
+#ifndef CLI_NO_EDITING
+    char* _history;             /**< Caller-provided history arena (ring of length-framed lines). */
+    size_t _historySize;        /**< Size of the _history arena. */
+    size_t _historyHead;        /**< Start of the oldest entry. */
+    size_t _historyUsed;        /**< Bytes in use. */
+    uint16_t _historyAdds;      /**< Count of lines added (wraps); moves entries under other sessions' cursors. */
+#endif
+
+    cli_dispatch_hook_t _dispatchHook; /**< Optional hook deferring command execution. */
+    void* _dispatchCtx;         /**< Context pointer for _dispatchHook. */
+    bool _dispatchPending;      /**< A deferred command has not completed yet. */
+    char _pendingTerminator;    /**< Line ending that submitted the deferred command, or 0. */
+
+    CLIInjectSlot* _inject;     /**< Caller-provided injection queue slots. */
+    uint16_t _injectMask;       /**< Slot count - 1 (count is a power of two). */
+    volatile uint16_t _injectTail; /**< Producers: next position to claim. */
+    uint16_t _injectHead;       /**< Consumer: next position to run. */
+
+    CLICommandRegistry* _registry; /**< Optional runtime command registry. */
+    int _readerSlot;            /**< Reader slot claimed from _registry. */
+    uint8_t _tablePins;         /**< Nesting depth of _pinTable(). */
+    const CLICommandTable* _unpinnedTable; /**< _table to restore when the last pin is released. */
+
+    CLIScheduler* _scheduler;   /**< Optional periodic command scheduler. */
+
+    char* _chain;               /**< Rest of a chained line still to run, or NULL. */
+    uint8_t _chainOp;           /**< Operator in front of _chain (CLI_CHAIN_*). */
+    char* _pipeBuffer;          /**< Caller-provided pipe storage, or NULL. */
+    size_t _pipeSize;           /**< Size of _pipeBuffer. */
+    int _status;                /**< Status of the last command run from a line. */
+    const CLI_Command_t* _command; /**< Command whose handler is running, for getContext(). */
+    bool _machineMode;          /**< Responses are framed; no echo or prompt. */
+    uint8_t _result;            /**< CLI_RESULT_* of the command being framed. */
+    uint16_t _frameSeq;         /**< Sequence number of the next frame. */
+    char* _responseBuffer;      /**< Caller-provided machine mode output storage, or NULL. */
+    size_t _responseSize;       /**< Size of _responseBuffer. */
+    const char* _requestId;     /**< "#id" of the line being run in machine mode, or NULL. */
+    bool _binaryMode;           /**< Input is COBS-framed binary packets. */
+    uint8_t* _binBuffer;        /**< Caller-provided decoded packet storage, or NULL. */
+    size_t _binSize;            /**< Size of _binBuffer. */
+    size_t _binLen;             /**< Decoded bytes of the current packet. */
+    uint8_t _binCode;           /**< COBS code of the current block (0xFF: no implicit zero). */
+    uint8_t _binRemaining;      /**< Data bytes left in the current COBS block. */
+    bool _binError;             /**< Current packet overflowed; dropped up to the delimiter. */
+    uint8_t _checksum;          /**< CLI_CHECKSUM_* required on received lines. */
+    uint8_t _format;            /**< CLI_FORMAT_* of the library's messages. */
+    CLIJsonWriter _json;        /**< Writer returned by json(). */
+    CLICborWriter _cbor;        /**< Encoder returned by cbor(). */
+
+    /**
+     * @brief Input loop of poll(), on a Stream or a concrete stream type (see ArduinoCLIT.h).
+     * @param stream The session's input stream (*_serial, possibly as its concrete type).
+     * @param maxBytes Maximum number of characters to read.
+     * @return Number of characters read.
+     * @private
+     */
+    template <class S> size_t _pollStream(S& stream, size_t maxBytes);
+
+    /**
+     * @brief Runs injected, scheduled and queued work at the start of poll().
+     * @return false if no input may be read now.
+     * @private
+     */
+    bool _pollBegin();
+
+    /**
+     * @brief Handles a line ending, Tab, Backspace, Ctrl+C or other control character.
+     * @return false if a command was deferred (stop reading).
+     * @private
+     */
+    bool _processControl(char c);
 
     /**
      * @brief Resets the input buffer position and clears its content.
@@ -173,22 +960,156 @@ private:
      */
     int _splitLine(char *line, char **argv_local, size_t max_args_local);
 
+    /**
+     * @brief Splits the first command off a chained line in one pass (modifies the line).
+     * ';', '&&', '||' and '|' end a command, with or without surrounding spaces.
+     * @param[in,out] line The line; set to the text after the operator, or NULL at the end.
+     * @param[out] argv_local The array to store argument pointers into.
+     * @param[in] max_args_local The maximum number of arguments to store in argv_local.
+     * @param[out] op The operator that ended the command (CLI_CHAIN_*).
+     * @return The number of arguments found (argc).
+     * @private
+     */
+    int _splitCommand(char **line, char **argv_local, size_t max_args_local, uint8_t *op);
+
+    /**
+     * @brief Splits a line that must hold a single command (prepare(), scripts, files).
+     * @param[in,out] line The input line string to be tokenized. Will be modified.
+     * @param[out] argv_local The array to store argument pointers into.
+     * @param[in] max_args_local The maximum number of arguments to store in argv_local.
+     * @return The number of arguments found (argc), or -1 if the line holds an operator.
+     * @private
+     */
+    int _splitSingle(char *line, char **argv_local, size_t max_args_local);
+
     /**
      * @brief Finds a command matching the given prefix. Handles exact matches preferentially.
      * @param[in] prefix The command name prefix to search for.
+     * @param[out] matchCount Optional; receives the number of commands starting with prefix.
      * @return Pointer to the matched CLI_Command_t, or NULL if not found or ambiguous.
      * @private
      */
-    const CLI_Command_t* _findCommand(const char *prefix);
+    const CLI_Command_t* _findCommand(const char *prefix, int *matchCount = nullptr);
 
     /**
      * @brief Parses and executes a command line stored in the line buffer.
-     * Finds command, validates arguments, prints pre-command newline, calls handler, handles errors.
+     * Runs each command of a ';' / '&&' / '||' chain in turn.
      * @param[in] line The completed command line string.
      * @private
      */
     void _parseAndExecute(char *line);
 
+    /**
+     * @brief Runs the commands left in _chain until it ends or one is deferred.
+     * @private
+     */
+    void _runChain();
+
+    /**
+     * @brief Finds the command in _argv, validates arguments, prints pre-command newline,
+     * calls handler, handles errors. Run with the command table pinned.
+     * @param argc Number of entries in _argv.
+     * @return The command's status (CLI_STATUS_FAIL if it did not resolve).
+     * @private
+     */
+    int _executePinned(int argc);
+
+    /**
+     * @brief Resolves the command in _argv and validates its arguments.
+     * @param argc Number of entries in _argv.
+     * @return The command, or NULL after printing an error.
+     * @private
+     */
+    const CLI_Command_t* _resolve(int argc);
+
+    /**
+     * @brief Runs a pipeline whose first command is in _argv; the rest follows in _chain.
+     * Run with the command table pinned.
+     * @return The last command's status, or CLI_STATUS_FAIL.
+     * @private
+     */
+    int _runPipeline(int argc);
+
+    /**
+     * @brief Runs a command or pipeline with its output collected, then sends it as a frame.
+     * Run with the command table pinned.
+     * @return The command's status.
+     * @private
+     */
+    int _runFramed(int argc);
+
+    /**
+     * @brief Sends a frame header and the first len bytes of _responseBuffer.
+     * @private
+     */
+    void _writeFrame(uint8_t result, size_t len);
+
+    /**
+     * @brief Writes {"error":"<error>"[,"command":"<command>"]} as JSON (and a newline)
+     * or CBOR.
+     * @private
+     */
+    void _formatError(const __FlashStringHelper* error, const char* command = nullptr);
+
+    /**
+     * @brief Drops the JSON and CBOR writers' nesting state before a top-level command.
+     * @private
+     */
+    void _resetWriters();
+
+    /**
+     * @brief Verifies and strips the "*XX" suffix of a received line.
+     * @return false if the checksum is missing or wrong.
+     * @private
+     */
+    bool _checkLine(char* line);
+
+    /**
+     * @brief Decodes one byte of a COBS-framed packet; runs the packet at its delimiter.
+     * @private
+     */
+    void _binaryByte(uint8_t c);
+
+    /**
+     * @brief Validates and runs a decoded packet, then replies.
+     * @private
+     */
+    void _runPacket();
+
+    /**
+     * @brief Sends a reply whose output (len bytes) is already in the response buffer.
+     * @private
+     */
+    void _binaryReply(uint8_t seq, uint8_t result, uint8_t status, size_t len);
+
+    /**
+     * @brief Drops the remaining commands of a pipeline from _chain.
+     * @private
+     */
+    void _skipPipeline();
+
+    /**
+     * @brief Calls the handler of a prepared command; the table must be pinned.
+     * Leaves a cancellation latched for the caller.
+     * @return false if the command could not be resolved.
+     * @private
+     */
+    bool _runPrepared(CLIPreparedCommand* prepared);
+
+    /**
+     * @brief Points _table at the registry's current snapshot and protects it (nestable).
+     * No-op without a registry.
+     * @private
+     */
+    void _pinTable();
+
+    /**
+     * @brief Releases a snapshot pinned with _pinTable().
+     * @private
+     */
+    void _unpinTable();
+
+#ifndef CLI_NO_TAB_COMPLETION
     /**
      * @brief Handles tab key press for command completion attempt.
      * Finds matches, attempts single completion or LCP completion, or lists options.
@@ -205,13 +1126,98 @@ private:
      * @private
      */
     int _findLcp(const char *matches[], int count);
+#endif
+
+    /**
+     * @brief Post-command bookkeeping (reports and clears a cancellation).
+     * @private
+     */
+    void _endCommand();
+
+    /**
+     * @brief Finishes a line: resets the buffer, prints the prompt and swallows a CRLF/LFCR pair.
+     * @param terminator The line ending character that ended the line, or 0.
+     * @private
+     */
+    void _endLine(char terminator);
+
+    /**
+     * @brief Moves all bytes available on the Stream into the type-ahead line queue.
+     * @private
+     */
+    void _drainToQueue();
+
+    /**
+     * @brief Executes every complete line waiting in the type-ahead queue.
+     * @return true if at least one line was executed.
+     * @private
+     */
+    bool _runQueuedLines();
+
+    /**
+     * @brief Moves a partial line drained from the Stream into the line buffer and echoes it.
+     * @private
+     */
+    void _restoreQueuedPartial();
+
+    /**
+     * @brief Executes every command waiting in the injection queue.
+     * @private
+     */
+    void _runInjected();
+
+#ifndef CLI_NO_EDITING
+    /**
+     * @brief Stores a typed line in the history arena (see CLIHistory.cpp).
+     * @private
+     */
+    void _addHistory(const char* line, size_t len);
 
     /**
-     * @brief Writes a single character to the serial port (for echoing).
-     * @param[in] c The character to write.
+     * @brief Gets the start of the history entry that ends at end.
      * @private
      */
-    void _printChar(char c);
+    size_t _historyBefore(size_t end) const;
+
+    /**
+     * @brief Replaces the line buffer with a history entry and redraws the difference.
+     * @private
+     */
+    void _recallHistory(size_t start);
+
+    void _historyUp();          /**< @private */
+    void _historyDown();        /**< @private */
+
+    /**
+     * @brief Feeds one byte of an escape sequence to the parser.
+     * @return false if c is not part of the sequence and must be handled as input.
+     * @private
+     */
+    bool _escapeByte(char c);
+
+    void _startSearch();        /**< @private */
+    void _endSearch();          /**< @private */
+
+    /**
+     * @brief Feeds one key to the Ctrl+R search.
+     * @return false if the key ends the search and must be handled as input.
+     * @private
+     */
+    bool _searchByte(char c);
+
+    /**
+     * @brief Finds the newest entry, starting at from, that holds the search pattern plus c.
+     * @return Start of the entry, or _historySize if none.
+     * @private
+     */
+    size_t _findHistory(size_t from, char c, size_t* off) const;
+
+    /**
+     * @brief Moves the terminal cursor n columns left.
+     * @private
+     */
+    void _cursorLeft(size_t n);
+#endif
 
     /**
      * @brief Allocates memory for internal line buffer and argv array.
@@ -228,4 +1234,61 @@ private:
 
 };
 
+inline int cli_invoke(const CLI_Command_t* cmd, ArduinoCLI* cli, int argc, char *argv[]) {
+    const CLI_Command_t* outer = cli->_command; /* A handler may run another command */
+    int status = CLI_STATUS_OK;
+    cli->_command = cmd;
+    if (cmd->flags & CLI_FLAG_STATUS) {
+        status = ((cli_status_handler_t)(void (*)(void))cmd->func)(cli, argc, argv);
+    } else {
+        cmd->func(cli, argc, argv);
+    }
+    cli->_command = outer;
+    return status;
+}
+
+/* --- Member Function Handlers --- */
+
+/** @private Strips a reference from decltype() of the bound object. */
+template <class T> struct cli_object_type { typedef T type; };
+template <class T> struct cli_object_type<T&> { typedef T type; };
+
+/**
+ * @brief Handler trampoline calling a member function on the command's ctx object.
+ * No heap and no std::function: the method is a template argument, the object is ctx.
+ */
+template <class T, void (T::*Method)(ArduinoCLI*, int, char *[])>
+void cli_method_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (static_cast<T*>(cli->getContext())->*Method)(cli, argc, argv);
+}
+
+/**
+ * @brief Status-returning variant of cli_method_handler().
+ */
+template <class T, int (T::*Method)(ArduinoCLI*, int, char *[])>
+int cli_method_status_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    return (static_cast<T*>(cli->getContext())->*Method)(cli, argc, argv);
+}
+
+/**
+ * @brief Table entry calling object.method(cli, argc, argv).
+ * Example: CLI_METHOD_COMMAND("m1", motor1, status, 0, "Motor 1 status")
+ * Several entries can bind the same method to different objects.
+ */
+#define CLI_METHOD_COMMAND(name, object, method, max_args, help_text) \
+    {name, \
+     &cli_method_handler<cli_object_type<decltype(object)>::type, \
+                         &cli_object_type<decltype(object)>::type::method>, \
+     max_args, CLI_HELP(help_text), 0, &(object)}
+
+/**
+ * @brief Table entry calling object.method(cli, argc, argv) where method returns a status.
+ */
+#define CLI_METHOD_STATUS_COMMAND(name, object, method, max_args, help_text) \
+    {name, \
+     (cli_command_handler_t)(void (*)(void)) \
+         &cli_method_status_handler<cli_object_type<decltype(object)>::type, \
+                                    &cli_object_type<decltype(object)>::type::method>, \
+     max_args, CLI_HELP(help_text), CLI_FLAG_STATUS, &(object)}
+
 #endif /* ArduinoCLI_h */
@@ -0,0 +1,146 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * ArduinoCLI front-end bound to a concrete stream type.                 *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file ArduinoCLIT.h
+ * \brief Defines ArduinoCLIT<StreamT>, whose poll() calls the stream without virtual dispatch.
+ */
+#ifndef ArduinoCLIT_h
+#define ArduinoCLIT_h
+
+#include "ArduinoCLI.h"
+#include <ctype.h>
+
+/**
+ * @brief Per-byte stream calls of poll().
+ * Qualified calls (s.S::read()) bind to S's own implementation at compile time, so they
+ * can be inlined. Stream itself keeps virtual dispatch.
+ */
+template <class S>
+struct cli_stream_ops {
+    static int available(S& s) { return s.S::available(); }
+    static int read(S& s) { return s.S::read(); }
+    static size_t write(S& s, uint8_t c) { return s.S::write(c); }
+};
+
+template <>
+struct cli_stream_ops<Stream> {
+    static int available(Stream& s) { return s.available(); }
+    static int read(Stream& s) { return s.read(); }
+    static size_t write(Stream& s, uint8_t c) { return s.write(c); }
+};
+
+/* Reads, stores and echoes printable characters; the rest goes to _processControl() */
+template <class S>
+size_t ArduinoCLI::_pollStream(S& stream, size_t maxBytes) {
+    size_t consumed = 0;
+    if (!_pollBegin()) return 0;
+
+    while (consumed < maxBytes && cli_stream_ops<S>::available(stream) > 0) {
+        char c = (char)cli_stream_ops<S>::read(stream);
+        consumed++;
+
+        if (_binaryMode) {
+            _binaryByte((uint8_t)c); /* May run a command */
+            continue;
+        }
+
+        if (_skipChar) {
+            char skip = _skipChar;
+            _skipChar = 0;
+            if (c == skip) continue; /* Pair of a line ending collected into the queue */
+        }
+
+#ifndef CLI_NO_EDITING
+        if (_searching && _searchByte(c)) continue; /* Ctrl+R */
+        if (_escape && _escapeByte(c)) continue; /* Arrow keys */
+#endif
+
+        /* Handle printable characters */
+        if (isprint(c)) {
+            if (_bufferPos < _maxLineLen - 1) {
+                _lineBuffer[_bufferPos++] = c;
+                _lineBuffer[_bufferPos] = '\0'; /* Keep null-terminated */
+#ifndef CLI_NO_ECHO
+                if (!_machineMode) cli_stream_ops<S>::write(stream, (uint8_t)c); /* Echo character */
+            } else if (!_machineMode) {
+                /* Buffer full: optional bell sound */
+                cli_stream_ops<S>::write(stream, '\a');
+#endif
+            }
+        } else if (!_processControl(c)) {
+            break; /* Command deferred */
+        }
+    }
+    return consumed;
+}
+
+/**
+ * @class ArduinoCLIT
+ * @brief ArduinoCLI whose poll() reads and echoes through the concrete stream type.
+ *
+ * ArduinoCLI talks to its Stream through virtual calls, several per input byte.
+ * ArduinoCLIT<HardwareSerial> (or any other final stream class) calls StreamT's
+ * methods directly instead, so the compiler can inline them. Only the per-byte path
+ * differs; prompts, errors and handler output still use getSerial().
+ * StreamT must be the exact type of the object, not a base class of it. poll() is
+ * hidden rather than overridden: polling through an ArduinoCLI& (e.g., from CLITask)
+ * takes the type-erased path.
+ */
+template <class StreamT>
+class ArduinoCLIT : public ArduinoCLI {
+public:
+    /**
+     * @brief Constructor for the ArduinoCLIT class.
+     * @param serialPort The stream object for communication.
+     * @param commands Array of CLI_Command_t structures defining the commands.
+     * @param commandCount The number of commands in the commands array.
+     */
+    ArduinoCLIT(StreamT& serialPort, const CLI_Command_t commands[], size_t commandCount) :
+        ArduinoCLI(serialPort, commands, commandCount),
+        _stream(serialPort)
+    {
+    }
+
+    /**
+     * @brief Constructor using a shared, prebuilt command table.
+     * @param serialPort The stream object for communication.
+     * @param table The command table (must outlive the CLI instance).
+     */
+    ArduinoCLIT(StreamT& serialPort, const CLICommandTable& table) :
+        ArduinoCLI(serialPort, table),
+        _stream(serialPort)
+    {
+    }
+
+    /**
+     * @brief Polls the stream for input and processes it (call in loop()).
+     */
+    void poll() {
+        _pollStream(_stream, (size_t)-1);
+    }
+
+    /**
+     * @brief Like poll(), but reads at most maxBytes characters.
+     * @param maxBytes Maximum number of characters to read.
+     * @return Number of characters read.
+     */
+    size_t poll(size_t maxBytes) {
+        return _pollStream(_stream, maxBytes);
+    }
+
+private:
+    StreamT& _stream;           /**< The stream, as its concrete type. */
+};
+
+#endif /* ArduinoCLIT_h */
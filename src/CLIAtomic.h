@@ -0,0 +1,121 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Minimal atomic operations portable across Arduino cores and hosts.    *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIAtomic.h
+ * \brief Sequentially consistent atomic load/store/exchange/CAS helpers.
+ *
+ * Cores without native atomics (AVR, ARMv6-M such as SAMD21) are single-core, so the
+ * operations run with interrupts masked; the previous interrupt state is restored, so
+ * they are also safe inside ISRs. Everything else uses the GCC __atomic builtins.
+ */
+#ifndef CLIAtomic_h
+#define CLIAtomic_h
+
+#include <stdint.h>
+
+#if defined(__AVR__) || defined(__ARM_ARCH_6M__)
+#define CLI_ATOMIC_IRQ_LOCK 1
+#endif
+
+#ifdef CLI_ATOMIC_IRQ_LOCK
+
+#if defined(__AVR__)
+#include <avr/io.h>
+typedef uint8_t cli_irq_state_t;
+static inline cli_irq_state_t cli_irq_save() {
+    cli_irq_state_t s = SREG;
+    __asm__ __volatile__("cli" ::: "memory");
+    return s;
+}
+static inline void cli_irq_restore(cli_irq_state_t s) {
+    __asm__ __volatile__("" ::: "memory");
+    SREG = s;
+}
+#else /* ARMv6-M */
+typedef uint32_t cli_irq_state_t;
+static inline cli_irq_state_t cli_irq_save() {
+    cli_irq_state_t s;
+    __asm__ __volatile__("mrs %0, primask\n\tcpsid i" : "=r"(s) :: "memory");
+    return s;
+}
+static inline void cli_irq_restore(cli_irq_state_t s) {
+    __asm__ __volatile__("msr primask, %0" :: "r"(s) : "memory");
+}
+#endif
+
+template <typename T> static inline T cli_atomic_load(T volatile* p) {
+    cli_irq_state_t s = cli_irq_save();
+    T v = *p;
+    cli_irq_restore(s);
+    return v;
+}
+
+template <typename T> static inline void cli_atomic_store(T volatile* p, T v) {
+    cli_irq_state_t s = cli_irq_save();
+    *p = v;
+    cli_irq_restore(s);
+}
+
+template <typename T> static inline T cli_atomic_exchange(T volatile* p, T v) {
+    cli_irq_state_t s = cli_irq_save();
+    T old = *p;
+    *p = v;
+    cli_irq_restore(s);
+    return old;
+}
+
+/* On failure *expected receives the current value */
+template <typename T> static inline bool cli_atomic_cas(T volatile* p, T* expected, T desired) {
+    cli_irq_state_t s = cli_irq_save();
+    bool ok = (*p == *expected);
+    if (ok) *p = desired;
+    else *expected = *p;
+    cli_irq_restore(s);
+    return ok;
+}
+
+template <typename T> static inline T cli_atomic_fetch_add(T volatile* p, T v) {
+    cli_irq_state_t s = cli_irq_save();
+    T old = *p;
+    *p = old + v;
+    cli_irq_restore(s);
+    return old;
+}
+
+#else /* GCC builtins */
+
+template <typename T> static inline T cli_atomic_load(T volatile* p) {
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+template <typename T> static inline void cli_atomic_store(T volatile* p, T v) {
+    __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+template <typename T> static inline T cli_atomic_exchange(T volatile* p, T v) {
+    return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+/* On failure *expected receives the current value */
+template <typename T> static inline bool cli_atomic_cas(T volatile* p, T* expected, T desired) {
+    return __atomic_compare_exchange_n(p, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+template <typename T> static inline T cli_atomic_fetch_add(T volatile* p, T v) {
+    return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+
+#endif /* CLI_ATOMIC_IRQ_LOCK */
+
+#endif /* CLIAtomic_h */
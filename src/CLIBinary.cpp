@@ -0,0 +1,221 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Binary transport: COBS-framed packets with CRC-16.                    *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIBinary.cpp
+ * \brief Implements the binary packet transport of ArduinoCLI.
+ *
+ * Packets are COBS-encoded and end with a 0x00 byte. Decoded (multi-byte values
+ * little-endian):
+ *
+ *     request:  seq:u8  commandIndex:u16  argc:u8  { len:u8  bytes[len] } * argc  crc:u16
+ *     reply:    seq:u8  result:u8  status:u8  output...  crc:u16
+ *
+ * commandIndex is the position in the CLI_Command_t array, as in compiled scripts, and
+ * argc excludes the command name. result is a CLI_RESULT_* code and status the handler's
+ * status (low byte). crc is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) of all bytes
+ * before it. A request with commandIndex CLI_BINARY_EXIT returns to text mode after its
+ * reply. A 0x00 byte always starts a new packet, so a host can resynchronize at any time.
+ */
+
+#include "ArduinoCLI.h"
+#include "CLIPipe.h"
+
+/* Half-byte table: 32 bytes of flash, two lookups per byte */
+static const uint16_t cli_crc16_table[16] PROGMEM = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static uint16_t cli_crc16(const uint8_t* p, size_t len) {
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        uint8_t b = *p++;
+        crc = (uint16_t)((crc << 4) ^ pgm_read_word(&cli_crc16_table[(crc >> 12) ^ (b >> 4)]));
+        crc = (uint16_t)((crc << 4) ^ pgm_read_word(&cli_crc16_table[(crc >> 12) ^ (b & 0x0F)]));
+    }
+    return crc;
+}
+
+/* COBS-encodes len bytes straight to the stream, then the 0x00 delimiter */
+static void cli_cobs_write(Stream& out, const uint8_t* p, size_t len) {
+    while (true) {
+        size_t n = 0;
+        while (n < len && n < 254 && p[n] != 0) n++;
+        out.write((uint8_t)(n + 1));
+        out.write(p, n);
+        if (n == len) break;
+        p += n;
+        len -= n;
+        if (n < 254) { /* Skip the zero the code byte stands for */
+            p++;
+            len--;
+        }
+    }
+    out.write((uint8_t)0);
+}
+
+void ArduinoCLI::setBinaryBuffer(uint8_t* buffer, size_t size) {
+    _binBuffer = (buffer && size > 0) ? buffer : nullptr;
+    _binSize = _binBuffer ? size : 0;
+    _binLen = 0;
+    _binCode = 0xFF;
+    _binRemaining = 0;
+    _binError = false;
+    if (!_binBuffer) _binaryMode = false;
+}
+
+bool ArduinoCLI::setBinaryMode(bool enable) {
+    if (enable && (!_binBuffer || _responseSize <= CLI_BINARY_OVERHEAD)) return false;
+    _binaryMode = enable;
+    _binLen = 0;
+    _binCode = 0xFF;
+    _binRemaining = 0;
+    _binError = false;
+    return true;
+}
+
+bool ArduinoCLI::isBinaryMode() const {
+    return _binaryMode;
+}
+
+void ArduinoCLI::_binaryByte(uint8_t c) {
+    if (c == 0) {
+        if (_binLen > 0 || _binError) _runPacket();
+        _binLen = 0;
+        _binCode = 0xFF;
+        _binRemaining = 0;
+        _binError = false;
+        return;
+    }
+    if (_binError) return;
+
+    bool data = (_binRemaining != 0);
+    if (!data && _binCode == 0xFF) { /* No implicit zero after a full block or at the start */
+        _binCode = c;
+        _binRemaining = (uint8_t)(c - 1);
+        return;
+    }
+    if (_binLen == _binSize) {
+        _binError = true; /* Too long: drop the rest */
+        return;
+    }
+    if (data) {
+        _binBuffer[_binLen++] = c;
+        _binRemaining--;
+    } else {
+        _binBuffer[_binLen++] = 0; /* Zero that ended the previous block */
+        _binCode = c;
+        _binRemaining = (uint8_t)(c - 1);
+    }
+}
+
+/* Output, if any, is already at _responseBuffer + 3 */
+void ArduinoCLI::_binaryReply(uint8_t seq, uint8_t result, uint8_t status, size_t len) {
+    uint8_t* reply = (uint8_t*)_responseBuffer;
+    reply[0] = seq;
+    reply[1] = result;
+    reply[2] = status;
+    len += 3;
+    uint16_t crc = cli_crc16(reply, len);
+    reply[len++] = (uint8_t)crc;
+    reply[len++] = (uint8_t)(crc >> 8);
+    cli_cobs_write(*_serial, reply, len);
+}
+
+void ArduinoCLI::_runPacket() {
+    uint8_t* p = _binBuffer;
+    size_t len = _binLen;
+    uint8_t seq = (len > 0) ? p[0] : 0;
+
+    /* Truncated block, overflow or damage */
+    if (_binError || _binRemaining != 0 || len < 6 ||
+        cli_crc16(p, len - 2) != (uint16_t)(p[len - 2] | (p[len - 1] << 8))) {
+        _binaryReply(seq, CLI_RESULT_BAD_FRAME, 0, 0);
+        return;
+    }
+    len -= 2;
+    uint16_t index = (uint16_t)(p[1] | (p[2] << 8));
+    uint8_t argc = p[3];
+
+    if (index == CLI_BINARY_EXIT) {
+        _binaryReply(seq, CLI_RESULT_OK, 0, 0);
+        _binaryMode = false;
+        _printPrompt();
+        return;
+    }
+    if ((size_t)argc + 2 > _maxArgs) {
+        _binaryReply(seq, CLI_RESULT_TOO_MANY_ARGS, 0, 0);
+        return;
+    }
+
+    /* Point argv into the packet; each string's terminator replaces the next length byte */
+    size_t pos = 4;
+    for (uint8_t a = 0; a < argc; a++) {
+        if (pos >= len || p[pos] > len - pos - 1) {
+            _binaryReply(seq, CLI_RESULT_BAD_FRAME, 0, 0);
+            return;
+        }
+        size_t n = p[pos];
+        if (a > 0) p[pos] = '\0'; /* Ends the previous argument */
+        _argv[a + 1] = (char*)(p + pos + 1);
+        pos += n + 1;
+    }
+    if (pos != len) {
+        _binaryReply(seq, CLI_RESULT_BAD_FRAME, 0, 0);
+        return;
+    }
+    p[len] = '\0'; /* Ends the last argument; the CRC was checked already */
+    _argv[argc + 1] = NULL;
+
+    _pinTable();
+    const CLI_Command_t* cmd = _table->command(index);
+    if (cmd == NULL || cmd->name == NULL) {
+        _unpinTable();
+        _binaryReply(seq, CLI_RESULT_UNKNOWN, 0, 0);
+        return;
+    }
+    if (argc > cmd->max_args) {
+        _unpinTable();
+        _binaryReply(seq, CLI_RESULT_TOO_MANY_ARGS, 0, 0);
+        return;
+    }
+    _argv[0] = (char*)cmd->name;
+
+    /* Input is packets, so the handler gets none; no hook, no type-ahead queue */
+    Stream* console = _serial;
+    CLIPipe out(_responseBuffer + 3, _responseSize - CLI_BINARY_OVERHEAD, this);
+    CLIPrintStream io(&out);
+    char* queue = _queue;
+    _queue = nullptr;
+    _serial = &io;
+
+    int status = CLI_STATUS_OK;
+    if (cmd->func != NULL) {
+        _cancelled = false;
+        _checkpointCountdown = _checkpointInterval;
+        _resetWriters();
+        status = cli_invoke(cmd, this, argc + 1, _argv);
+    }
+    _serial = console;
+    _queue = queue;
+    _unpinTable();
+
+    uint8_t result = CLI_RESULT_OK;
+    if (out.overflowed()) result = CLI_RESULT_OVERFLOW;
+    else if (_cancelled) result = CLI_RESULT_CANCELLED;
+    else if (status != CLI_STATUS_OK) result = CLI_RESULT_FAILED;
+    _cancelled = false;
+    _status = (result == CLI_RESULT_OK || result == CLI_RESULT_FAILED) ? status : CLI_STATUS_FAIL;
+    _binaryReply(seq, result, (uint8_t)status, (size_t)out.available());
+}
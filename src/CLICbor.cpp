@@ -0,0 +1,297 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Streaming CBOR (RFC 8949) encoder for command output.                 *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLICbor.cpp
+ * \brief Implements the CLICborWriter class.
+ */
+
+#include "CLICbor.h"
+#include <string.h>
+
+#if CLI_CBOR_MAX_DEPTH > 32
+#error "CLI_CBOR_MAX_DEPTH must not exceed 32"
+#endif
+
+/* Major types */
+#define CBOR_UINT   0
+#define CBOR_NINT   1
+#define CBOR_BYTES  2
+#define CBOR_TEXT   3
+#define CBOR_ARRAY  4
+#define CBOR_MAP    5
+
+/* Initial bytes of major type 7 */
+#define CBOR_FALSE  0xF4
+#define CBOR_TRUE   0xF5
+#define CBOR_NULL   0xF6
+#define CBOR_FLOAT  0xFA
+#define CBOR_DOUBLE 0xFB
+#define CBOR_BREAK  0xFF
+
+CLICborWriter::CLICborWriter(Print* out) :
+    _out(out),
+    _buffer(nullptr),
+    _size(0),
+    _len(0),
+    _indefinite(0),
+    _depth(0),
+    _skip(0),
+    _overflow(false)
+{
+}
+
+void CLICborWriter::setOutput(Print* out) {
+    _out = out;
+    _buffer = nullptr;
+    _size = 0;
+}
+
+void CLICborWriter::setBuffer(uint8_t* buffer, size_t size) {
+    _out = nullptr;
+    _buffer = buffer;
+    _size = buffer ? size : 0;
+    _len = 0;
+}
+
+size_t CLICborWriter::length() const {
+    return _len;
+}
+
+void CLICborWriter::reset() {
+    _depth = 0;
+    _skip = 0;
+    _overflow = false;
+}
+
+uint8_t CLICborWriter::depth() const {
+    return _depth;
+}
+
+bool CLICborWriter::overflowed() const {
+    return _overflow;
+}
+
+bool CLICborWriter::_item() {
+    if (_skip || (!_out && !_buffer)) return false;
+    if (_depth == 0) _overflow = false; /* A new top-level item */
+    else if (_left[_depth - 1]) _left[_depth - 1]--;
+    return true;
+}
+
+void CLICborWriter::_write(const uint8_t* p, size_t n) {
+    if (_out) {
+        _out->write(p, n);
+        return;
+    }
+    if (n > _size - _len) {
+        n = _size - _len;
+        _overflow = true;
+    }
+    memcpy(_buffer + _len, p, n);
+    _len += n;
+}
+
+void CLICborWriter::_head(uint8_t major, unsigned long arg) {
+    uint8_t head[9];
+    uint8_t n;
+    if (arg < 24) {
+        head[0] = (uint8_t)((major << 5) | arg);
+        _write(head, 1);
+        return;
+    }
+    if (arg <= 0xFFUL) n = 1;
+    else if (arg <= 0xFFFFUL) n = 2;
+    else if ((arg >> 16) >> 16 == 0) n = 4;
+    else n = 8;                         /* 64-bit long only */
+    head[0] = (uint8_t)((major << 5) | (n == 1 ? 24 : n == 2 ? 25 : n == 4 ? 26 : 27));
+    for (uint8_t i = 0; i < n; i++) {   /* Big-endian */
+        head[n - i] = (uint8_t)(arg >> (8 * i));
+    }
+    _write(head, n + 1);
+}
+
+CLICborWriter& CLICborWriter::_begin(uint8_t major, long count) {
+    if (_skip || _depth == CLI_CBOR_MAX_DEPTH) {
+        if (!_skip) null(); /* Keeps the enclosing item count */
+        _skip++;
+        _overflow = true;
+        return *this;
+    }
+    if (!_item()) return *this;
+    uint32_t bit = 1UL << _depth;
+    if (count < 0) {
+        uint8_t b = (uint8_t)((major << 5) | 31);
+        _write(&b, 1);
+        _indefinite |= bit;
+        _left[_depth] = 0;
+    } else {
+        _head(major, (unsigned long)count);
+        _indefinite &= ~bit;
+        _left[_depth] = (major == CBOR_MAP) ? 2 * (size_t)count : (size_t)count;
+    }
+    _depth++;
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::_end() {
+    if (_skip) {
+        _skip--;
+        return *this;
+    }
+    if (_depth == 0) return *this;
+    _depth--;
+    if (_indefinite & (1UL << _depth)) {
+        uint8_t b = CBOR_BREAK;
+        _write(&b, 1);
+    }
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::beginObject() {
+    return _begin(CBOR_MAP, -1);
+}
+
+CLICborWriter& CLICborWriter::beginObject(size_t pairs) {
+    return _begin(CBOR_MAP, (long)pairs);
+}
+
+CLICborWriter& CLICborWriter::endObject() {
+    return _end();
+}
+
+CLICborWriter& CLICborWriter::beginArray() {
+    return _begin(CBOR_ARRAY, -1);
+}
+
+CLICborWriter& CLICborWriter::beginArray(size_t count) {
+    return _begin(CBOR_ARRAY, (long)count);
+}
+
+CLICborWriter& CLICborWriter::endArray() {
+    return _end();
+}
+
+CLICborWriter& CLICborWriter::end() {
+    while (_skip) _skip--;
+    while (_depth) {
+        while (_left[_depth - 1] && (_out || _buffer)) null(); /* A counted level cut short still decodes */
+        _end();
+    }
+    return *this;
+}
+
+void CLICborWriter::_text(const char* s, bool flash) {
+    size_t len = flash ? strlen_P(s) : strlen(s);
+    _head(CBOR_TEXT, len);
+    if (!flash) {
+        _write((const uint8_t*)s, len);
+        return;
+    }
+    while (len--) {
+        uint8_t c = pgm_read_byte(s++);
+        _write(&c, 1);
+    }
+}
+
+CLICborWriter& CLICborWriter::key(const char* name) {
+    if (_item()) _text(name ? name : "", false);
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::key(const __FlashStringHelper* name) {
+    if (_item()) _text((const char*)name, true);
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::value(const char* s) {
+    if (!s) return null();
+    if (_item()) _text(s, false);
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::value(const __FlashStringHelper* s) {
+    if (!s) return null();
+    if (_item()) _text((const char*)s, true);
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::value(bool b) {
+    if (_item()) {
+        uint8_t c = b ? CBOR_TRUE : CBOR_FALSE;
+        _write(&c, 1);
+    }
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::value(int n) {
+    return value((long)n);
+}
+
+CLICborWriter& CLICborWriter::value(unsigned int n) {
+    return value((unsigned long)n);
+}
+
+CLICborWriter& CLICborWriter::value(long n) {
+    if (!_item()) return *this;
+    if (n < 0) _head(CBOR_NINT, (unsigned long)(-1 - n)); /* -1 - n cannot overflow */
+    else _head(CBOR_UINT, (unsigned long)n);
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::value(unsigned long n) {
+    if (_item()) _head(CBOR_UINT, n);
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::value(float f) {
+    if (!_item()) return *this;
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    uint8_t out[5] = { CBOR_FLOAT, (uint8_t)(bits >> 24), (uint8_t)(bits >> 16),
+                       (uint8_t)(bits >> 8), (uint8_t)bits };
+    _write(out, sizeof(out));
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::value(double d, uint8_t digits) {
+    (void)digits;
+    if (sizeof(double) == sizeof(float) || (double)(float)d == d || d != d) {
+        return value((float)d);
+    }
+    if (!_item()) return *this;
+    uint64_t bits = 0;
+    memcpy(&bits, &d, sizeof(d));
+    uint8_t out[9];
+    out[0] = CBOR_DOUBLE;
+    for (uint8_t i = 0; i < 8; i++) {
+        out[8 - i] = (uint8_t)(bits >> (8 * i));
+    }
+    _write(out, sizeof(out));
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::bytes(const uint8_t* data, size_t len) {
+    if (!_item()) return *this;
+    _head(CBOR_BYTES, len);
+    if (len) _write(data, len);
+    return *this;
+}
+
+CLICborWriter& CLICborWriter::null() {
+    if (_item()) {
+        uint8_t c = CBOR_NULL;
+        _write(&c, 1);
+    }
+    return *this;
+}
@@ -0,0 +1,197 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Streaming CBOR (RFC 8949) encoder for command output.                 *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLICbor.h
+ * \brief Defines the CLICborWriter class returned by ArduinoCLI::cbor().
+ */
+#ifndef CLICbor_h
+#define CLICbor_h
+
+#include <Arduino.h>
+
+#ifndef CLI_CBOR_MAX_DEPTH
+#define CLI_CBOR_MAX_DEPTH 8        /**< Maximum nesting of maps and arrays (at most 32). */
+#endif
+
+/**
+ * @class CLICborWriter
+ * @brief Encodes CBOR straight to a Print or a caller-provided buffer: no DOM, no heap.
+ *
+ * The calls match CLIJsonWriter, so the same code can produce either format:
+ *
+ *     cli->cbor().beginObject().key("temp").value(23.5).key("ok").value(true).endObject();
+ *
+ * beginObject()/beginArray() without a count start indefinite-length containers,
+ * closed with endObject()/endArray(). With a count (pairs for a map) the header
+ * holds the length, one byte smaller, and the end call writes nothing; end() pads
+ * one that is still short of its count with nulls. A container
+ * nested deeper than CLI_CBOR_MAX_DEPTH is written as null and its contents are
+ * dropped, so the enclosing counts stay valid; overflowed() reports it, as it does
+ * a full buffer.
+ */
+class CLICborWriter {
+public:
+    /**
+     * @brief Constructor for the CLICborWriter class.
+     * @param out Destination, or NULL until setOutput() is called.
+     */
+    explicit CLICborWriter(Print* out = nullptr);
+
+    /**
+     * @brief Writes to a Print; the nesting state is kept.
+     * @param out Destination.
+     */
+    void setOutput(Print* out);
+
+    /**
+     * @brief Writes to a buffer instead of a Print, from its start.
+     * @param buffer Caller-provided storage.
+     * @param size Size of buffer in bytes.
+     */
+    void setBuffer(uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Gets the number of bytes in the buffer (see setBuffer()).
+     * @return Bytes written.
+     */
+    size_t length() const;
+
+    /** @brief Starts an indefinite-length map. */
+    CLICborWriter& beginObject();
+    /** @brief Starts a map of the given number of key/value pairs. */
+    CLICborWriter& beginObject(size_t pairs);
+    /** @brief Ends the innermost map. */
+    CLICborWriter& endObject();
+    /** @brief Starts an indefinite-length array. */
+    CLICborWriter& beginArray();
+    /** @brief Starts an array of the given number of items. */
+    CLICborWriter& beginArray(size_t count);
+    /** @brief Ends the innermost array. */
+    CLICborWriter& endArray();
+
+    /**
+     * @brief Writes a map key as a text string; the next call writes its value.
+     * @param name Key.
+     */
+    CLICborWriter& key(const char* name);
+    CLICborWriter& key(const __FlashStringHelper* name);
+
+    /**
+     * @brief Writes a value: a text string (null for a NULL pointer), a simple value or
+     * an integer in the shortest form.
+     */
+    CLICborWriter& value(const char* s);
+    CLICborWriter& value(const __FlashStringHelper* s);
+    CLICborWriter& value(bool b);
+    CLICborWriter& value(int n);
+    CLICborWriter& value(unsigned int n);
+    CLICborWriter& value(long n);
+    CLICborWriter& value(unsigned long n);
+
+    /**
+     * @brief Writes a float as single precision (5 bytes).
+     * @param f The number.
+     */
+    CLICborWriter& value(float f);
+
+    /**
+     * @brief Writes a double as single precision if that is exact, else as double
+     * precision (9 bytes). On AVR double is float.
+     * @param d The number.
+     * @param digits Ignored; for source compatibility with CLIJsonWriter.
+     */
+    CLICborWriter& value(double d, uint8_t digits = 2);
+
+    /**
+     * @brief Writes a byte string.
+     * @param data Bytes.
+     * @param len Number of bytes.
+     */
+    CLICborWriter& bytes(const uint8_t* data, size_t len);
+
+    /** @brief Writes null. */
+    CLICborWriter& null();
+
+    /**
+     * @brief Closes every open map and array; missing items of counted ones become null.
+     */
+    CLICborWriter& end();
+
+    /**
+     * @brief Forgets any open maps and arrays (a new item starts).
+     */
+    void reset();
+
+    /**
+     * @brief Gets the current nesting depth.
+     * @return Number of open maps and arrays.
+     */
+    uint8_t depth() const;
+
+    /**
+     * @brief Checks whether output was dropped, by nesting or a full buffer.
+     * @return true if output was dropped since the top-level item started.
+     */
+    bool overflowed() const;
+
+private:
+    Print* _out;                /**< Destination, or NULL when writing to _buffer. */
+    uint8_t* _buffer;           /**< Destination buffer, or NULL. */
+    size_t _size;               /**< Size of _buffer. */
+    size_t _len;                /**< Bytes in _buffer. */
+    uint32_t _indefinite;       /**< Bit per open level: needs a break byte at the end. */
+    size_t _left[CLI_CBOR_MAX_DEPTH]; /**< Items still owed by each counted level (keys count). */
+    uint8_t _depth;             /**< Open levels that are written. */
+    uint8_t _skip;              /**< Open levels beyond CLI_CBOR_MAX_DEPTH that are dropped. */
+    bool _overflow;             /**< Output was dropped. */
+
+    /**
+     * @brief Starts an item; resets the overflow flag at the top level.
+     * @return false if output is being dropped.
+     * @private
+     */
+    bool _item();
+
+    /**
+     * @brief Writes bytes to the Print or the buffer.
+     * @private
+     */
+    void _write(const uint8_t* p, size_t n);
+
+    /**
+     * @brief Writes the head of an item: major type and argument, shortest form.
+     * @private
+     */
+    void _head(uint8_t major, unsigned long arg);
+
+    /**
+     * @brief Opens a level; count < 0 for indefinite length.
+     * @private
+     */
+    CLICborWriter& _begin(uint8_t major, long count);
+
+    /**
+     * @brief Closes the innermost level.
+     * @private
+     */
+    CLICborWriter& _end();
+
+    /**
+     * @brief Writes a text string; flash selects PROGMEM reads.
+     * @private
+     */
+    void _text(const char* s, bool flash);
+};
+
+#endif /* CLICbor_h */
@@ -0,0 +1,242 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Runtime command registration with lock-free readers (RCU-style).      *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLICommandRegistry.cpp
+ * \brief Implements the CLICommandRegistry class.
+ */
+
+#include "CLICommandRegistry.h"
+#include "CLIAtomic.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* One published version: command array plus its lookup index */
+struct CLICommandRegistry::Snapshot {
+    CLI_Command_t* commands;    /* Owned, malloc'd */
+    CLICommandTable table;
+    Snapshot* nextRetired;
+
+    Snapshot(CLI_Command_t* cmds, size_t count) :
+        commands(cmds),
+        table(cmds, count),
+        nextRetired(nullptr)
+    {
+    }
+
+    ~Snapshot() {
+        free(commands);
+    }
+};
+
+CLICommandRegistry::CLICommandRegistry(const CLI_Command_t commands[], size_t commandCount, size_t maxReaders) :
+    _current(nullptr),
+    _hazards(nullptr),
+    _slotUsed(nullptr),
+    _maxReaders(0),
+    _retired(nullptr),
+    _writerLock(0),
+    _version(0)
+{
+    _hazards = (Snapshot* volatile*)calloc(maxReaders, sizeof(Snapshot*));
+    _slotUsed = (volatile uint8_t*)calloc(maxReaders, 1);
+    if (_hazards && _slotUsed) _maxReaders = maxReaders;
+
+    if (!commands) commandCount = 0;
+    CLI_Command_t* copy = (CLI_Command_t*)malloc((commandCount ? commandCount : 1) * sizeof(CLI_Command_t));
+    if (copy) {
+        if (commandCount) memcpy(copy, commands, commandCount * sizeof(CLI_Command_t));
+        _publish(copy, commandCount);
+    }
+}
+
+CLICommandRegistry::~CLICommandRegistry() {
+    delete _current;
+    while (_retired) {
+        Snapshot* next = _retired->nextRetired;
+        delete _retired;
+        _retired = next;
+    }
+    free((void*)_hazards);
+    free((void*)_slotUsed);
+}
+
+/* --- Writer Side --- */
+
+void CLICommandRegistry::_lock() {
+    uint8_t expected = 0;
+    while (!cli_atomic_cas(&_writerLock, &expected, (uint8_t)1)) {
+        expected = 0;
+        yield();
+    }
+}
+
+void CLICommandRegistry::_unlock() {
+    cli_atomic_store(&_writerLock, (uint8_t)0);
+}
+
+bool CLICommandRegistry::_publish(CLI_Command_t* commands, size_t count) {
+    Snapshot* next = new Snapshot(commands, count);
+    if (!next) {
+        free(commands);
+        return false;
+    }
+
+    Snapshot* old = cli_atomic_exchange(&_current, next);
+    _version++;
+    if (old) {
+        old->nextRetired = _retired;
+        _retired = old;
+    }
+    _reclaimLocked();
+    return true;
+}
+
+bool CLICommandRegistry::add(const CLI_Command_t commands[], size_t count) {
+    if (!commands || count == 0) return false;
+
+    _lock();
+    const CLICommandTable* cur = _current ? &_current->table : nullptr; /* NULL if nothing was published yet */
+    size_t oldCount = cur ? cur->count() : 0;
+
+    /* Reject NULL or duplicate names, including duplicates within the batch */
+    for (size_t i = 0; i < count; i++) {
+        bool bad = (commands[i].name == NULL);
+        for (size_t j = 0; !bad && j < oldCount; j++) {
+            const char* name = cur->command(j)->name;
+            bad = (name != NULL && strcmp(name, commands[i].name) == 0);
+        }
+        for (size_t j = 0; !bad && j < i; j++) {
+            bad = (strcmp(commands[j].name, commands[i].name) == 0);
+        }
+        if (bad) {
+            _unlock();
+            return false;
+        }
+    }
+
+    CLI_Command_t* next = (CLI_Command_t*)malloc((oldCount + count) * sizeof(CLI_Command_t));
+    bool ok = false;
+    if (next) {
+        if (oldCount) memcpy(next, cur->command(0), oldCount * sizeof(CLI_Command_t));
+        memcpy(next + oldCount, commands, count * sizeof(CLI_Command_t));
+        ok = _publish(next, oldCount + count);
+    }
+    _unlock();
+    return ok;
+}
+
+bool CLICommandRegistry::add(const CLI_Command_t& command) {
+    return add(&command, 1);
+}
+
+bool CLICommandRegistry::remove(const char* name) {
+    if (!name) return false;
+
+    _lock();
+    if (!_current) { /* Nothing was published yet */
+        _unlock();
+        return false;
+    }
+    const CLICommandTable& cur = _current->table;
+    size_t oldCount = cur.count();
+    size_t victim = oldCount;
+    for (size_t i = 0; i < oldCount; i++) {
+        const char* n = cur.command(i)->name;
+        if (n != NULL && strcmp(n, name) == 0) {
+            victim = i;
+            break;
+        }
+    }
+
+    bool ok = false;
+    if (victim < oldCount) {
+        CLI_Command_t* next = (CLI_Command_t*)malloc((oldCount > 1 ? oldCount - 1 : 1) * sizeof(CLI_Command_t));
+        if (next) {
+            size_t n = 0;
+            for (size_t i = 0; i < oldCount; i++) {
+                if (i != victim) next[n++] = *cur.command(i);
+            }
+            ok = _publish(next, n);
+        }
+    }
+    _unlock();
+    return ok;
+}
+
+size_t CLICommandRegistry::reclaim() {
+    _lock();
+    size_t pending = _reclaimLocked();
+    _unlock();
+    return pending;
+}
+
+/* Free every retired snapshot that no reader slot points to */
+size_t CLICommandRegistry::_reclaimLocked() {
+    size_t pending = 0;
+    Snapshot** link = &_retired;
+    while (*link) {
+        Snapshot* s = *link;
+        bool inUse = false;
+        for (size_t i = 0; i < _maxReaders && !inUse; i++) {
+            inUse = (cli_atomic_load(&_hazards[i]) == s);
+        }
+        if (inUse) {
+            link = &s->nextRetired;
+            pending++;
+        } else {
+            *link = s->nextRetired;
+            delete s;
+        }
+    }
+    return pending;
+}
+
+unsigned long CLICommandRegistry::version() const {
+    return _version;
+}
+
+/* --- Reader Side (lock-free) --- */
+
+int CLICommandRegistry::registerReader() {
+    for (size_t i = 0; i < _maxReaders; i++) {
+        uint8_t expected = 0;
+        if (cli_atomic_cas(&_slotUsed[i], &expected, (uint8_t)1)) return (int)i;
+    }
+    return -1;
+}
+
+void CLICommandRegistry::unregisterReader(int slot) {
+    if (slot < 0 || (size_t)slot >= _maxReaders) return;
+    cli_atomic_store(&_hazards[slot], (Snapshot*)nullptr);
+    cli_atomic_store(&_slotUsed[slot], (uint8_t)0);
+}
+
+const CLICommandTable* CLICommandRegistry::acquire(int slot) {
+    Snapshot* s = cli_atomic_load(&_current);
+    if (!s) return nullptr; /* Out of memory before the first publish */
+    if (slot < 0 || (size_t)slot >= _maxReaders) return &s->table; /* Unprotected */
+
+    /* Announce, then confirm the snapshot was not replaced in between */
+    while (true) {
+        cli_atomic_store(&_hazards[slot], s);
+        Snapshot* again = cli_atomic_load(&_current);
+        if (again == s) return &s->table;
+        s = again;
+    }
+}
+
+void CLICommandRegistry::release(int slot) {
+    if (slot < 0 || (size_t)slot >= _maxReaders) return;
+    cli_atomic_store(&_hazards[slot], (Snapshot*)nullptr);
+}
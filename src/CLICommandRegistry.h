@@ -0,0 +1,143 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Runtime command registration with lock-free readers (RCU-style).      *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLICommandRegistry.h
+ * \brief Defines the CLICommandRegistry class for adding and removing commands at runtime.
+ */
+#ifndef CLICommandRegistry_h
+#define CLICommandRegistry_h
+
+#include "ArduinoCLI.h"
+
+#define CLI_DEFAULT_REGISTRY_READERS 8 /**< Default number of reader slots (one per session). */
+
+/**
+ * @class CLICommandRegistry
+ * @brief Mutable command set published as immutable CLICommandTable snapshots.
+ *
+ * add() and remove() build a new command array and lookup index off to the side and
+ * publish it with a single atomic pointer swap. Readers (ArduinoCLI sessions) never lock:
+ * each owns a reader slot and announces the snapshot it uses there (a hazard pointer) for
+ * the duration of a lookup and command. A replaced snapshot is freed once no slot refers
+ * to it. Writers are serialized with a spin lock and may run on any thread or task, but
+ * not in an ISR.
+ *
+ * The registry copies CLI_Command_t entries, but not the strings they point to: names and
+ * help texts must outlive the registry (string literals are fine).
+ */
+class CLICommandRegistry {
+public:
+    /**
+     * @brief Constructor for the CLICommandRegistry class.
+     * @param commands Initial commands (copied); may be NULL.
+     * @param commandCount Number of initial commands.
+     * @param maxReaders Number of reader slots, i.e. sessions that may use the registry.
+     */
+    CLICommandRegistry(const CLI_Command_t commands[], size_t commandCount,
+                       size_t maxReaders = CLI_DEFAULT_REGISTRY_READERS);
+
+    /**
+     * @brief Destructor. All readers must have been unregistered.
+     */
+    ~CLICommandRegistry();
+
+    /**
+     * @brief Adds commands and publishes the new table.
+     * @param commands Commands to add (copied).
+     * @param count Number of commands.
+     * @return false if a name already exists, is NULL, or memory is exhausted; nothing is published then.
+     */
+    bool add(const CLI_Command_t commands[], size_t count);
+
+    /**
+     * @brief Adds one command and publishes the new table.
+     * @param command The command to add (copied).
+     * @return false if the name already exists or memory is exhausted.
+     */
+    bool add(const CLI_Command_t& command);
+
+    /**
+     * @brief Removes a command by exact name and publishes the new table.
+     * @param name The command name.
+     * @return false if no such command exists or memory is exhausted.
+     */
+    bool remove(const char* name);
+
+    /**
+     * @brief Frees replaced tables that no reader refers to any more.
+     * Called automatically by add() and remove().
+     * @return Number of replaced tables still waiting for readers.
+     */
+    size_t reclaim();
+
+    /**
+     * @brief Claims a reader slot.
+     * @return The slot, or -1 if all slots are taken.
+     */
+    int registerReader();
+
+    /**
+     * @brief Releases a reader slot claimed with registerReader().
+     * @param slot The slot.
+     */
+    void unregisterReader(int slot);
+
+    /**
+     * @brief Protects and returns the current table for a reader. Lock-free.
+     * The table stays valid until release() is called for the same slot.
+     * @param slot The reader's slot.
+     * @return The current command table, or NULL if none could be published (out of memory).
+     */
+    const CLICommandTable* acquire(int slot);
+
+    /**
+     * @brief Ends a reader's use of the table returned by acquire().
+     * @param slot The reader's slot.
+     */
+    void release(int slot);
+
+    /**
+     * @brief Gets the number of tables published so far (starts at 1).
+     * @return The version counter.
+     */
+    unsigned long version() const;
+
+private:
+    struct Snapshot;
+
+    Snapshot* volatile _current;   /**< Published snapshot. */
+    Snapshot* volatile* _hazards;  /**< Snapshot in use per reader slot, or NULL. */
+    volatile uint8_t* _slotUsed;   /**< Reader slot claims. */
+    size_t _maxReaders;            /**< Number of reader slots. */
+    Snapshot* _retired;            /**< Replaced snapshots waiting for readers (writer only). */
+    volatile uint8_t _writerLock;  /**< Serializes add()/remove()/reclaim(). */
+    unsigned long _version;        /**< Published table count. */
+
+    /**
+     * @brief Publishes a new command array (takes ownership) and retires the old snapshot.
+     * @private
+     */
+    bool _publish(CLI_Command_t* commands, size_t count);
+
+    /**
+     * @brief Frees unreferenced retired snapshots. Writer lock must be held.
+     * @private
+     */
+    size_t _reclaimLocked();
+
+    void _lock();   /**< @private */
+    void _unlock(); /**< @private */
+};
+
+#endif /* CLICommandRegistry_h */
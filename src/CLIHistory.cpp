@@ -0,0 +1,314 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Command history in a caller-provided ring arena.                      *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIHistory.cpp
+ * \brief Implements the command history of ArduinoCLI.
+ *
+ * The arena is a byte ring of entries, oldest first:
+ *
+ *     len:u8  bytes[len]  len:u8
+ *
+ * The length is stored on both sides so the ring can be walked in either direction
+ * without an index. Entries wrap around the end of the arena byte by byte; adding one
+ * evicts the oldest until it fits.
+ *
+ * Built with CLI_NO_EDITING there is no history: setHistoryBuffer() does nothing.
+ */
+
+#include "ArduinoCLI.h"
+
+#ifndef CLI_NO_EDITING
+
+/* Ring positions: advance / go back n bytes (n <= size) */
+static inline size_t cli_ring_fwd(size_t pos, size_t n, size_t size) {
+    pos += n;
+    return (pos >= size) ? pos - size : pos;
+}
+
+static inline size_t cli_ring_back(size_t pos, size_t n, size_t size) {
+    return (pos >= n) ? pos - n : pos + size - n;
+}
+
+void ArduinoCLI::setHistoryBuffer(char* arena, size_t size) {
+    _history = (arena && size > 2) ? arena : nullptr;
+    _historySize = _history ? size : 0;
+    _historyHead = 0;
+    _historyUsed = 0;
+    _historyCursor = _historySize;
+    _historySeen = ++_historyAdds;
+}
+
+/* Start of the entry that ends at end */
+size_t ArduinoCLI::_historyBefore(size_t end) const {
+    size_t last = cli_ring_back(end, 1, _historySize);
+    return cli_ring_back(last, (uint8_t)_history[last] + 1, _historySize);
+}
+
+void ArduinoCLI::_addHistory(const char* line, size_t len) {
+    if (!_history || len == 0 || len > 255 || len + 2 > _historySize) return;
+    size_t tail = cli_ring_fwd(_historyHead, _historyUsed, _historySize);
+
+    /* Consecutive duplicate */
+    if (_historyUsed > 0) {
+        size_t pos = _historyBefore(tail);
+        if ((uint8_t)_history[pos] == len) {
+            size_t i = 0;
+            pos = cli_ring_fwd(pos, 1, _historySize);
+            while (i < len && _history[pos] == line[i]) {
+                pos = cli_ring_fwd(pos, 1, _historySize);
+                i++;
+            }
+            if (i == len) return;
+        }
+    }
+
+    /* Evict the oldest entries until the line fits */
+    while (_historyUsed + len + 2 > _historySize) {
+        size_t old = (uint8_t)_history[_historyHead] + 2;
+        _historyHead = cli_ring_fwd(_historyHead, old, _historySize);
+        _historyUsed -= old;
+    }
+
+    _history[tail] = (char)len;
+    for (size_t i = 0; i < len; i++) {
+        tail = cli_ring_fwd(tail, 1, _historySize);
+        _history[tail] = line[i];
+    }
+    tail = cli_ring_fwd(tail, 1, _historySize);
+    _history[tail] = (char)len;
+    _historyUsed += len + 2;
+    _historySeen = ++_historyAdds;
+}
+
+/* Replaces the line with an entry (or an empty line for _historySize), redrawing only what differs */
+void ArduinoCLI::_recallHistory(size_t start) {
+    size_t len = 0;
+    size_t pos = start;
+    if (start != _historySize) {
+        len = (uint8_t)_history[start];
+        if (len > _maxLineLen - 1) len = _maxLineLen - 1;
+        pos = cli_ring_fwd(start, 1, _historySize);
+    }
+
+    /* Keep the common prefix on screen */
+    size_t same = 0;
+    while (same < len && same < _bufferPos && _lineBuffer[same] == _history[pos]) {
+        pos = cli_ring_fwd(pos, 1, _historySize);
+        same++;
+    }
+#ifndef CLI_NO_ECHO
+    for (size_t i = same; i < _bufferPos; i++) _serial->write('\b');
+#endif
+    for (size_t i = same; i < len; i++) {
+        _lineBuffer[i] = _history[pos];
+        pos = cli_ring_fwd(pos, 1, _historySize);
+    }
+    _lineBuffer[len] = '\0';
+#ifndef CLI_NO_ECHO
+    _serial->print(_lineBuffer + same);
+    if (len < _bufferPos) _serial->print(F("\x1b[K")); /* Erase the rest of the old line */
+#endif
+    _bufferPos = len;
+}
+
+/* Up arrow: one entry older */
+void ArduinoCLI::_historyUp() {
+    if (_historyUsed == 0) return;
+    size_t start;
+    if (_historyCursor == _historySize) {
+        start = _historyBefore(cli_ring_fwd(_historyHead, _historyUsed, _historySize));
+    } else if (_historyCursor == _historyHead) {
+        return; /* Oldest entry */
+    } else {
+        start = _historyBefore(_historyCursor);
+    }
+    _historyCursor = start;
+    _recallHistory(start);
+}
+
+/* Down arrow: one entry newer, then back to an empty line */
+void ArduinoCLI::_historyDown() {
+    if (_historyCursor == _historySize) return;
+    size_t next = cli_ring_fwd(_historyCursor, (uint8_t)_history[_historyCursor] + 2, _historySize);
+    if (next == cli_ring_fwd(_historyHead, _historyUsed, _historySize)) {
+        next = _historySize; /* Past the newest entry */
+    }
+    _historyCursor = next;
+    _recallHistory(next);
+}
+
+/* ESC [ or ESC O, parameters, then a final byte (VT100 cursor keys: A up, B down) */
+bool ArduinoCLI::_escapeByte(char c) {
+    if (_escape == 1) {
+        if (c == '[' || c == 'O') {
+            _escape = 2;
+            return true;
+        }
+        _escape = 0;
+        return false; /* Lone ESC: c is ordinary input */
+    }
+    if (c >= 0x20 && c < 0x40) return true; /* Parameter and intermediate bytes */
+    _escape = 0;
+    if (c < 0x40 || c > 0x7E) return false;
+    if (c == 'A') _historyUp();
+    else if (c == 'B') _historyDown();
+    return true; /* Other keys are ignored */
+}
+
+/* --- Reverse Search (Ctrl+R) --- */
+
+/*
+ * The line shows  (reverse-i-search)`pattern': match  with the cursor after the
+ * pattern. The match is in the line buffer, so Enter runs it, and the pattern is
+ * always a substring of it: _searchOff/_searchLen locate it, no other storage is
+ * needed. A character that would leave no match is refused with a bell.
+ */
+
+void ArduinoCLI::_cursorLeft(size_t n) {
+    if (n == 0) return;
+    _serial->print(F("\x1b["));
+    _serial->print((unsigned long)n);
+    _serial->print('D');
+}
+
+void ArduinoCLI::_startSearch() {
+    if (!_history || _machineMode) return;
+    _searching = true;
+    _searchOff = 0;
+    _searchLen = 0;
+#ifndef CLI_NO_ECHO
+    _serial->print(F("\r(reverse-i-search)`': "));
+    _serial->print(_lineBuffer);
+    _serial->print(F("\x1b[K"));
+    _cursorLeft(_bufferPos + 3);
+#endif
+}
+
+/* Back to the prompt, keeping the match as the line being edited */
+void ArduinoCLI::_endSearch() {
+    _searching = false;
+#ifndef CLI_NO_ECHO
+    _serial->write('\r');
+    _serial->print(_prompt);
+    _serial->print(_lineBuffer);
+    _serial->print(F("\x1b[K"));
+#endif
+}
+
+/* Newest entry at or before from that holds the pattern (plus c, if not 0); sets *off */
+size_t ArduinoCLI::_findHistory(size_t from, char c, size_t* off) const {
+    size_t plen = _searchLen + (c ? 1 : 0);
+    size_t start = from;
+    while (true) {
+        size_t len = (uint8_t)_history[start];
+        if (len > _maxLineLen - 1) len = _maxLineLen - 1;
+        for (size_t o = 0; o + plen <= len; o++) {
+            size_t pos = cli_ring_fwd(start, o + 1, _historySize);
+            size_t i = 0;
+            while (i < plen && _history[pos] == (i < _searchLen ? _lineBuffer[_searchOff + i] : c)) {
+                pos = cli_ring_fwd(pos, 1, _historySize);
+                i++;
+            }
+            if (i == plen) {
+                *off = o;
+                return start;
+            }
+        }
+        if (start == _historyHead) return _historySize; /* Oldest entry */
+        start = _historyBefore(start);
+    }
+}
+
+/* A key while searching; false if it ends the search and is handled as usual */
+bool ArduinoCLI::_searchByte(char c) {
+    size_t from = _historySize; /* No match possible */
+    char add = 0;
+    if (isprint(c)) {
+        if (_historyCursor != _historySize) from = _historyCursor; /* The match may still hold */
+        add = c;
+    } else if (c == CLI_CTRL_R) { /* Next older match */
+        if (_historyCursor != _historySize && _historyCursor != _historyHead) {
+            from = _historyBefore(_historyCursor);
+        }
+    } else if (c == 127 || c == '\b') { /* Shorter pattern, same match */
+        if (_searchLen > 0) {
+            _searchLen--;
+#ifndef CLI_NO_ECHO
+            _serial->print(F("\b\x1b[P"));
+#endif
+        }
+        return true;
+    } else if (c == CLI_CTRL_C) {
+        _searching = false; /* Line is dropped anyway */
+        return false;
+    } else {
+        _endSearch(); /* Enter runs the match; Tab, arrows etc. edit it */
+        return false;
+    }
+
+    if (_historyCursor == _historySize && _historyUsed > 0) {
+        from = _historyBefore(cli_ring_fwd(_historyHead, _historyUsed, _historySize)); /* Newest */
+    }
+    size_t off = 0;
+    size_t entry = (from == _historySize || _searchLen == 255) ? _historySize : _findHistory(from, add, &off);
+    if (entry == _historySize) {
+#ifndef CLI_NO_ECHO
+        _serial->write('\a');
+#endif
+        return true;
+    }
+
+    if (entry == _historyCursor && off == _searchOff) {
+        /* Same match: only the pattern grows (insert one character) */
+        _searchLen++;
+#ifndef CLI_NO_ECHO
+        _serial->print(F("\x1b[@"));
+        _serial->write(add);
+#endif
+        return true;
+    }
+
+    /* Another match: redraw from the end of the pattern */
+    size_t len = (uint8_t)_history[entry];
+    if (len > _maxLineLen - 1) len = _maxLineLen - 1;
+#ifndef CLI_NO_ECHO
+    if (add) _serial->write(add);
+#endif
+    size_t pos = entry;
+    for (size_t i = 0; i < len; i++) {
+        pos = cli_ring_fwd(pos, 1, _historySize);
+        _lineBuffer[i] = _history[pos];
+    }
+    _lineBuffer[len] = '\0';
+    _bufferPos = len;
+    _historyCursor = entry;
+    _searchOff = (uint8_t)off;
+    _searchLen = (uint8_t)(_searchLen + (add ? 1 : 0));
+#ifndef CLI_NO_ECHO
+    _serial->print(F("': "));
+    _serial->print(_lineBuffer);
+    _serial->print(F("\x1b[K"));
+    _cursorLeft(len + 3);
+#endif
+    return true;
+}
+
+#else /* CLI_NO_EDITING */
+
+void ArduinoCLI::setHistoryBuffer(char* arena, size_t size) {
+    (void)arena; /* Unused */
+    (void)size;  /* Unused */
+}
+
+#endif /* CLI_NO_EDITING */
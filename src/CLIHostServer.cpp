@@ -0,0 +1,533 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Host-only telnet/TCP front-end (Linux epoll) for ArduinoCLI sessions. *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIHostServer.cpp
+ * \brief Implements the CLISocketStream and CLIHostServer classes.
+ */
+
+#include "CLIHostServer.h"
+
+#ifdef CLI_HOST_SERVER
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+/* Telnet protocol bytes */
+#define TELNET_IAC  255
+#define TELNET_SB   250
+#define TELNET_SE   240
+#define TELNET_WILL 251
+#define TELNET_DONT 254
+
+/* IAC parser states */
+enum {
+    IAC_DATA = 0,   /* Plain data */
+    IAC_SEEN,       /* Got IAC */
+    IAC_OPTION,     /* Got IAC WILL/WONT/DO/DONT, skip option byte */
+    IAC_SUBNEG,     /* Inside IAC SB ... */
+    IAC_SUBNEG_IAC  /* Got IAC inside subnegotiation */
+};
+
+/* --- Socket Stream --- */
+
+CLISocketStream::CLISocketStream() :
+    _fd(-1),
+    _rxHead(0),
+    _rxLen(0),
+    _txLen(0),
+    _iacState(IAC_DATA),
+    _dropped(0)
+{
+}
+
+void CLISocketStream::attach(int fd) {
+    _fd = fd;
+    _rxHead = 0;
+    _rxLen = 0;
+    _txLen = 0;
+    _iacState = IAC_DATA;
+    _dropped = 0;
+}
+
+int CLISocketStream::available() {
+    return (int)(_rxLen - _rxHead);
+}
+
+int CLISocketStream::read() {
+    return (_rxHead < _rxLen) ? _rx[_rxHead++] : -1;
+}
+
+int CLISocketStream::peek() {
+    return (_rxHead < _rxLen) ? _rx[_rxHead] : -1;
+}
+
+size_t CLISocketStream::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t CLISocketStream::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        if (_txLen == sizeof(_tx)) {
+            send(); /* Make room without blocking */
+            if (_txLen == sizeof(_tx)) {
+                _dropped += size - written; /* Peer is not reading */
+                break;
+            }
+        }
+        size_t chunk = sizeof(_tx) - _txLen;
+        if (chunk > size - written) chunk = size - written;
+        memcpy(_tx + _txLen, buffer + written, chunk);
+        _txLen += chunk;
+        written += chunk;
+    }
+    return size; /* Report success so Print does not stop mid-line */
+}
+
+void CLISocketStream::flush() {
+    send();
+}
+
+bool CLISocketStream::pending() const {
+    return _txLen > 0;
+}
+
+unsigned long CLISocketStream::dropped() const {
+    return _dropped;
+}
+
+int CLISocketStream::receive() {
+    if (_fd < 0) return -1;
+    if (_rxHead < _rxLen) return (int)(_rxLen - _rxHead); /* Previous batch not consumed */
+
+    ssize_t n = ::recv(_fd, _rx, sizeof(_rx), 0);
+    if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? -2 : -1;
+    if (n == 0) return 0;
+
+    _rxHead = 0;
+    _rxLen = _stripTelnet(_rx, (size_t)n);
+    return (int)n;
+}
+
+bool CLISocketStream::send() {
+    if (_fd < 0) return false;
+    size_t sent = 0;
+    while (sent < _txLen) {
+        ssize_t n = ::send(_fd, _tx + sent, _txLen - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        sent += (size_t)n;
+    }
+    if (sent > 0) {
+        memmove(_tx, _tx + sent, _txLen - sent);
+        _txLen -= sent;
+    }
+    return true;
+}
+
+/* Drop IAC negotiation so only user data reaches the line discipline */
+size_t CLISocketStream::_stripTelnet(uint8_t* data, size_t len) {
+    size_t out = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        switch (_iacState) {
+        case IAC_DATA:
+            if (b == TELNET_IAC) _iacState = IAC_SEEN;
+            else data[out++] = b;
+            break;
+        case IAC_SEEN:
+            if (b == TELNET_IAC) { data[out++] = b; _iacState = IAC_DATA; } /* Escaped 255 */
+            else if (b >= TELNET_WILL && b <= TELNET_DONT) _iacState = IAC_OPTION;
+            else if (b == TELNET_SB) _iacState = IAC_SUBNEG;
+            else _iacState = IAC_DATA; /* Two-byte command */
+            break;
+        case IAC_OPTION:
+            _iacState = IAC_DATA;
+            break;
+        case IAC_SUBNEG:
+            if (b == TELNET_IAC) _iacState = IAC_SUBNEG_IAC;
+            break;
+        default: /* IAC_SUBNEG_IAC */
+            _iacState = (b == TELNET_SE) ? IAC_DATA : IAC_SUBNEG;
+            break;
+        }
+    }
+    return out;
+}
+
+
+/* --- Host Server --- */
+
+/* Per-connection state, allocated once with the pool */
+struct CLIHostServer::Connection : CLIWorkerPool::Job {
+    CLISocketStream stream;     /* Must precede cli */
+    ArduinoCLI cli;
+    int fd;
+    bool registered;            /* fd is in the epoll set */
+    bool wantWrite;             /* EPOLLOUT currently registered */
+
+    /* Deferred command, owned by a worker until completion */
+    CLIHostServer* server;
+    const CLI_Command_t* cmd;
+    int argc;
+    char** argv;
+    int status;                 /* Handler result, for '&&' / '||' */
+    Connection* doneNext;
+
+    Connection(CLIHostServer* owner, const CLICommandTable& table) :
+        cli(stream, table),
+        fd(-1),
+        registered(false),
+        wantWrite(false),
+        server(owner),
+        cmd(nullptr),
+        argc(0),
+        argv(nullptr),
+        status(CLI_STATUS_OK),
+        doneNext(nullptr)
+    {
+        run = &CLIHostServer::_runJob;
+        serialized = true;
+    }
+};
+
+CLIHostServer::CLIHostServer(const CLI_Command_t commands[], size_t commandCount, size_t maxConnections) :
+    _table(commands, commandCount),
+    _pool(nullptr),
+    _free(nullptr),
+    _poolSize(0),
+    _freeCount(0),
+    _listenFd(-1),
+    _epollFd(-1),
+    _workerThreads(0),
+    _eventFd(-1),
+    _done(nullptr)
+{
+    strncpy(_prompt, CLI_DEFAULT_PROMPT, CLI_MAX_PROMPT_LEN - 1);
+    _prompt[CLI_MAX_PROMPT_LEN - 1] = '\0';
+
+    _pool = new Connection*[maxConnections];
+    _free = new Connection*[maxConnections];
+    for (size_t i = 0; i < maxConnections; i++) {
+        _pool[i] = new Connection(this, _table);
+    }
+    for (size_t i = 0; i < maxConnections; i++) {
+        _free[i] = _pool[maxConnections - 1 - i]; /* Hand out low slots first */
+    }
+    _poolSize = maxConnections;
+    _freeCount = maxConnections;
+}
+
+CLIHostServer::~CLIHostServer() {
+    end();
+    for (size_t i = 0; i < _poolSize; i++) {
+        delete _pool[i];
+    }
+    delete[] _pool;
+    delete[] _free;
+}
+
+void CLIHostServer::setPrompt(const char* prompt) {
+    if (prompt) {
+        strncpy(_prompt, prompt, CLI_MAX_PROMPT_LEN - 1);
+        _prompt[CLI_MAX_PROMPT_LEN - 1] = '\0';
+    }
+}
+
+void CLIHostServer::setWorkerThreads(size_t threads) {
+    _workerThreads = threads;
+}
+
+size_t CLIHostServer::connections() const {
+    return _poolSize - _freeCount;
+}
+
+bool CLIHostServer::setCommandRegistry(CLICommandRegistry* registry) {
+    bool ok = true;
+    for (size_t i = 0; i < _poolSize; i++) {
+        if (!_pool[i]->cli.setCommandRegistry(registry)) ok = false;
+    }
+    return ok;
+}
+
+const CLICommandTable& CLIHostServer::table() const {
+    return _table;
+}
+
+bool CLIHostServer::begin(uint16_t port, const char* bindAddress) {
+    end();
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, bindAddress, &addr.sin_addr) != 1) return false;
+
+    _listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_listenFd < 0) return false;
+
+    int one = 1;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(_listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(_listenFd, SOMAXCONN) < 0) {
+        end();
+        return false;
+    }
+
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd < 0) {
+        end();
+        return false;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr; /* NULL marks the listener */
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _listenFd, &ev) < 0) {
+        end();
+        return false;
+    }
+
+    if (_workerThreads > 0) {
+        _eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        ev.events = EPOLLIN;
+        ev.data.ptr = &_eventFd; /* Marks worker completions */
+        if (_eventFd < 0 || epoll_ctl(_epollFd, EPOLL_CTL_ADD, _eventFd, &ev) < 0 ||
+            !_workers.begin(_workerThreads)) {
+            end();
+            return false;
+        }
+    }
+    return true;
+}
+
+void CLIHostServer::end() {
+    _workers.end(); /* No handler may run while connections are torn down */
+    _done = nullptr;
+    for (size_t i = 0; i < _poolSize; i++) {
+        _pool[i]->cli.cancelDispatch(); /* Dropped or unreported jobs: unpin the table */
+        _pool[i]->cmd = nullptr;
+    }
+    if (_eventFd >= 0) {
+        close(_eventFd);
+        _eventFd = -1;
+    }
+    for (size_t i = 0; i < _poolSize; i++) {
+        if (_pool[i]->fd >= 0) _close(_pool[i]);
+    }
+    if (_epollFd >= 0) {
+        close(_epollFd);
+        _epollFd = -1;
+    }
+    if (_listenFd >= 0) {
+        close(_listenFd);
+        _listenFd = -1;
+    }
+}
+
+int CLIHostServer::poll(int timeoutMs) {
+    if (_epollFd < 0) return -1;
+
+    struct epoll_event events[CLI_HOST_MAX_EVENTS];
+    int n = epoll_wait(_epollFd, events, CLI_HOST_MAX_EVENTS, timeoutMs);
+    if (n < 0) return (errno == EINTR) ? 0 : -1;
+
+    for (int i = 0; i < n; i++) {
+        void* ptr = events[i].data.ptr;
+        if (ptr == nullptr) {
+            _accept();
+        } else if (ptr == &_eventFd) {
+            _completions();
+        } else {
+            Connection* conn = (Connection*)ptr;
+            _service(conn, events[i].events);
+        }
+    }
+    return n;
+}
+
+/* Accept every pending connection; refuse when the pool is exhausted */
+void CLIHostServer::_accept() {
+    while (true) {
+        int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; /* EAGAIN or transient error */
+
+        if (_freeCount == 0) {
+            static const char busy[] = "Error: Too many sessions.\r\n";
+            ::send(fd, busy, sizeof(busy) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+            close(fd);
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Connection* conn = _free[--_freeCount];
+        conn->fd = fd;
+        conn->registered = false;
+        conn->wantWrite = false;
+        conn->stream.attach(fd);
+        conn->cmd = nullptr;
+        conn->status = CLI_STATUS_OK;
+
+        conn->cli.resetSession(); /* Nothing from the previous connection carries over */
+        conn->cli.setDispatchHook(_workerThreads > 0 ? &CLIHostServer::_dispatch : nullptr, conn);
+        conn->cli.setPrompt(_prompt);
+        conn->cli.start(); /* Prompt goes into the transmit buffer */
+        if (!_flush(conn)) _close(conn);
+    }
+}
+
+/* One batched receive, run the line discipline over it, one batched send */
+void CLIHostServer::_service(Connection* conn, uint32_t events) {
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        _close(conn);
+        return;
+    }
+
+    if (events & EPOLLIN) {
+        int n = conn->stream.receive();
+        if (n == 0 || n == -1) {
+            _close(conn);
+            return;
+        }
+        _process(conn);
+        return;
+    }
+    else if (events & EPOLLRDHUP) {
+        _close(conn);
+        return;
+    }
+
+    if (!_flush(conn)) _close(conn);
+}
+
+void CLIHostServer::_process(Connection* conn) {
+    conn->cli.poll();
+    if (conn->cli.isDispatchPending()) return; /* A worker owns the connection now */
+    if (!conn->cli.isRunning()) {
+        /* 'exit' or similar: deliver the final output, then hang up */
+        conn->stream.send();
+        _close(conn);
+        return;
+    }
+    if (!_flush(conn)) _close(conn);
+}
+
+bool CLIHostServer::_flush(Connection* conn) {
+    if (!conn->stream.send()) return false;
+
+    bool want = conn->stream.pending();
+    if (!conn->registered || want != conn->wantWrite) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP | (want ? (uint32_t)EPOLLOUT : 0);
+        ev.data.ptr = conn;
+        int op = conn->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+        if (epoll_ctl(_epollFd, op, conn->fd, &ev) < 0) return false;
+        conn->registered = true;
+        conn->wantWrite = want;
+    }
+    return true;
+}
+
+/* --- Worker Dispatch --- */
+
+/* I/O thread: command parsed and resolved, hand the connection to a worker */
+bool CLIHostServer::_dispatch(void* ctx, ArduinoCLI* cli, const CLI_Command_t* cmd, int argc, char *argv[]) {
+    (void)cli;
+    Connection* conn = (Connection*)ctx;
+    CLIHostServer* server = conn->server;
+
+    /* Stop watching the socket: the stream belongs to the worker until completion */
+    if (conn->registered) {
+        epoll_ctl(server->_epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+        conn->registered = false;
+        conn->wantWrite = false;
+    }
+    conn->cmd = cmd;
+    conn->argc = argc;
+    conn->argv = argv;
+    conn->serialized = !(cmd->flags & CLI_FLAG_THREAD_SAFE);
+    server->_workers.submit(conn);
+    return true;
+}
+
+/* Worker thread: run the handler, then queue the connection for the I/O thread */
+void CLIHostServer::_runJob(CLIWorkerPool::Job* job) {
+    Connection* conn = static_cast<Connection*>(job);
+    CLIHostServer* server = conn->server;
+
+    conn->status = cli_invoke(conn->cmd, &conn->cli, conn->argc, conn->argv);
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lk(server->_doneLock);
+        wake = (server->_done == nullptr);
+        conn->doneNext = server->_done;
+        server->_done = conn;
+    }
+    if (wake) {
+        uint64_t one = 1;
+        ssize_t r = write(server->_eventFd, &one, sizeof(one));
+        (void)r;
+    }
+}
+
+/* I/O thread: resume sessions whose command finished */
+void CLIHostServer::_completions() {
+    uint64_t count;
+    ssize_t r = read(_eventFd, &count, sizeof(count));
+    (void)r;
+
+    Connection* list;
+    {
+        std::lock_guard<std::mutex> lk(_doneLock);
+        list = _done;
+        _done = nullptr;
+    }
+    while (list) {
+        Connection* conn = list;
+        list = conn->doneNext;
+
+        conn->cli.completeDispatch(conn->status); /* Rest of the line, prompt, then any further queued input */
+        if (conn->cli.isDispatchPending()) continue;
+        _process(conn); /* Rest of the receive batch; re-arms the socket */
+    }
+}
+
+void CLIHostServer::_close(Connection* conn) {
+    if (conn->fd < 0) return;
+    if (conn->registered && _epollFd >= 0) epoll_ctl(_epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    close(conn->fd);
+    conn->fd = -1;
+    conn->registered = false;
+    conn->stream.attach(-1);
+    conn->cli.stop();
+    _free[_freeCount++] = conn;
+}
+
+#endif /* CLI_HOST_SERVER */
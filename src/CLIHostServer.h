@@ -0,0 +1,250 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Host-only telnet/TCP front-end (Linux epoll) for ArduinoCLI sessions. *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIHostServer.h
+ * \brief Defines the CLIHostServer class for serving a command table over TCP on a Linux host.
+ *
+ * Only compiled when building for a Linux host (e.g., with EpoxyDuino); on boards this
+ * header declares nothing.
+ */
+#ifndef CLIHostServer_h
+#define CLIHostServer_h
+
+#include "ArduinoCLI.h"
+#include "CLIWorkerPool.h"
+
+#ifdef CLI_HOST_SERVER
+
+#define CLI_HOST_DEFAULT_MAX_CONNECTIONS 4096 /**< Default size of the connection pool. */
+#define CLI_HOST_RX_BUFFER 2048     /**< Per-connection receive batch size in bytes. */
+#define CLI_HOST_TX_BUFFER 4096     /**< Per-connection transmit buffer size in bytes. */
+#define CLI_HOST_MAX_EVENTS 256     /**< epoll events handled per poll(). */
+
+/**
+ * @class CLISocketStream
+ * @brief Stream over a non-blocking socket with batched receive and transmit buffers.
+ *
+ * Input is filled by one recv() per readiness event, with telnet IAC negotiation removed.
+ * Output is collected in a fixed buffer and sent with as few send() calls as possible.
+ */
+class CLISocketStream : public Stream {
+public:
+    CLISocketStream();
+
+    /* Stream / Print interface */
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    void flush() override;
+    using Print::write;
+
+    /**
+     * @brief Binds the stream to a connected socket and clears both buffers.
+     * @param fd The socket descriptor, or -1 to unbind.
+     */
+    void attach(int fd);
+
+    /**
+     * @brief Receives one batch of input from the socket.
+     * @return Bytes received, 0 on orderly shutdown, -1 on error, or -2 if no data (EAGAIN).
+     */
+    int receive();
+
+    /**
+     * @brief Sends as much buffered output as the socket accepts without blocking.
+     * @return false on a socket error.
+     */
+    bool send();
+
+    /**
+     * @brief Checks whether output is still waiting for the socket.
+     * @return true if the transmit buffer is not empty.
+     */
+    bool pending() const;
+
+    /**
+     * @brief Gets the number of output bytes dropped because the transmit buffer was full.
+     * @return Dropped byte count.
+     */
+    unsigned long dropped() const;
+
+private:
+    int _fd;                        /**< Socket descriptor, or -1. */
+    uint8_t _rx[CLI_HOST_RX_BUFFER]; /**< Receive batch. */
+    size_t _rxHead;                 /**< Next byte to read from _rx. */
+    size_t _rxLen;                  /**< Bytes valid in _rx. */
+    uint8_t _tx[CLI_HOST_TX_BUFFER]; /**< Output waiting to be sent. */
+    size_t _txLen;                  /**< Bytes valid in _tx. */
+    uint8_t _iacState;              /**< Telnet IAC parser state carried across batches. */
+    unsigned long _dropped;         /**< Output bytes dropped on overflow. */
+
+    /**
+     * @brief Removes telnet IAC sequences from a received batch in place.
+     * @return The new batch length.
+     * @private
+     */
+    size_t _stripTelnet(uint8_t* data, size_t len);
+};
+
+/**
+ * @class CLIHostServer
+ * @brief Non-blocking epoll TCP listener serving ArduinoCLI sessions on a Linux host.
+ *
+ * All connection state (socket stream, session, buffers) comes from a pool allocated once
+ * in the constructor; connections beyond the pool size are refused. Every session shares one
+ * CLICommandTable. Call poll() repeatedly from loop() or a host main loop.
+ *
+ * With setWorkerThreads(), line editing, tokenizing and command lookup stay on the thread
+ * calling poll() while handlers run on a CLIWorkerPool. A session has at most one command in
+ * flight, so its output stays in order. Commands flagged CLI_FLAG_THREAD_SAFE run in
+ * parallel; all others are serialized.
+ */
+class CLIHostServer {
+public:
+    /**
+     * @brief Constructor for the CLIHostServer class.
+     * @param commands Pointer to an array of CLI_Command_t structures defining the available commands.
+     * @param commandCount The number of commands in the commands array.
+     * @param maxConnections Size of the connection pool.
+     */
+    CLIHostServer(const CLI_Command_t commands[], size_t commandCount,
+                  size_t maxConnections = CLI_HOST_DEFAULT_MAX_CONNECTIONS);
+    ~CLIHostServer();
+
+    /**
+     * @brief Starts listening.
+     * @param port TCP port.
+     * @param bindAddress IPv4 address to bind (localhost by default).
+     * @return true on success.
+     */
+    bool begin(uint16_t port, const char* bindAddress = "127.0.0.1");
+
+    /**
+     * @brief Closes all connections and the listener, and stops the worker threads.
+     * Handlers already running finish first; deferred commands that never ran are cancelled.
+     */
+    void end();
+
+    /**
+     * @brief Runs command handlers on a pool of worker threads. Call before begin().
+     * @param threads Number of workers; 0 runs handlers inline on the poll() thread.
+     */
+    void setWorkerThreads(size_t threads);
+
+    /**
+     * @brief Resolves commands of every connection through a runtime registry. Call before begin().
+     * The registry needs one reader slot per pooled connection (maxConnections).
+     * @param registry The registry (must outlive the server), or NULL for the fixed table.
+     * @return false if the registry ran out of reader slots.
+     */
+    bool setCommandRegistry(CLICommandRegistry* registry);
+
+    /**
+     * @brief Waits for socket events and services ready connections.
+     * @param timeoutMs epoll timeout (0 to return immediately, -1 to block).
+     * @return Number of events handled, or -1 if the server is not running.
+     */
+    int poll(int timeoutMs = 0);
+
+    /**
+     * @brief Sets the prompt given to new sessions.
+     * @param prompt The prompt string (max length CLI_MAX_PROMPT_LEN).
+     */
+    void setPrompt(const char* prompt);
+
+    /**
+     * @brief Gets the number of open connections.
+     * @return Connections in use.
+     */
+    size_t connections() const;
+
+    /**
+     * @brief Gets the shared command table.
+     * @return Reference to the command table and lookup index.
+     */
+    const CLICommandTable& table() const;
+
+private:
+    struct Connection;
+
+    CLICommandTable _table;     /**< Shared, immutable command table and index. */
+    Connection** _pool;         /**< Connection pool (allocated once). */
+    Connection** _free;         /**< Stack of free connections. */
+    size_t _poolSize;           /**< Number of connections in the pool. */
+    size_t _freeCount;          /**< Number of entries on the free stack. */
+    int _listenFd;              /**< Listening socket, or -1. */
+    int _epollFd;               /**< epoll instance, or -1. */
+    char _prompt[CLI_MAX_PROMPT_LEN]; /**< Prompt for new sessions. */
+
+    CLIWorkerPool _workers;     /**< Handler threads (when _workerThreads > 0). */
+    size_t _workerThreads;      /**< Requested number of handler threads. */
+    int _eventFd;               /**< Wakes poll() when workers complete commands, or -1. */
+    std::mutex _doneLock;       /**< Guards _done. */
+    Connection* _done;          /**< Connections whose deferred command completed. */
+
+    /**
+     * @brief Accepts all pending connections.
+     * @private
+     */
+    void _accept();
+
+    /**
+     * @brief Handles readiness events for one connection.
+     * @private
+     */
+    void _service(Connection* conn, uint32_t events);
+
+    /**
+     * @brief Runs the line discipline over received input and flushes the output.
+     * @private
+     */
+    void _process(Connection* conn);
+
+    /**
+     * @brief Dispatch hook: hands a resolved command to the worker pool.
+     * @private
+     */
+    static bool _dispatch(void* ctx, ArduinoCLI* cli, const CLI_Command_t* cmd, int argc, char *argv[]);
+
+    /**
+     * @brief Worker-side job: runs the handler and reports completion.
+     * @private
+     */
+    static void _runJob(CLIWorkerPool::Job* job);
+
+    /**
+     * @brief Resumes connections whose deferred command completed.
+     * @private
+     */
+    void _completions();
+
+    /**
+     * @brief Flushes output and updates the connection's epoll interest set.
+     * @return false if the connection failed.
+     * @private
+     */
+    bool _flush(Connection* conn);
+
+    /**
+     * @brief Closes a connection and returns it to the pool.
+     * @private
+     */
+    void _close(Connection* conn);
+};
+
+#endif /* CLI_HOST_SERVER */
+
+#endif /* CLIHostServer_h */
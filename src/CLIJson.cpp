@@ -0,0 +1,225 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Streaming JSON writer for command output.                             *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIJson.cpp
+ * \brief Implements the CLIJsonWriter class.
+ */
+
+#include "CLIJson.h"
+#include <math.h>
+
+#if CLI_JSON_MAX_DEPTH > 32
+#error "CLI_JSON_MAX_DEPTH must not exceed 32"
+#endif
+
+CLIJsonWriter::CLIJsonWriter(Print* out) :
+    _out(out),
+    _arrays(0),
+    _items(0),
+    _depth(0),
+    _skip(0),
+    _afterKey(false),
+    _overflow(false)
+{
+}
+
+void CLIJsonWriter::setOutput(Print* out) {
+    _out = out;
+}
+
+void CLIJsonWriter::reset() {
+    _depth = 0;
+    _skip = 0;
+    _afterKey = false;
+    _overflow = false;
+}
+
+uint8_t CLIJsonWriter::depth() const {
+    return _depth;
+}
+
+bool CLIJsonWriter::overflowed() const {
+    return _overflow;
+}
+
+bool CLIJsonWriter::_item() {
+    if (_skip || !_out) return false;
+    if (_afterKey) {
+        _afterKey = false; /* Value of a member */
+        return true;
+    }
+    if (_depth == 0) {
+        _overflow = false; /* A new document */
+        return true;
+    }
+    uint32_t bit = 1UL << (_depth - 1);
+    if (_items & bit) _out->print(',');
+    _items |= bit;
+    return true;
+}
+
+CLIJsonWriter& CLIJsonWriter::_begin(char open, bool array) {
+    if (_skip || _depth == CLI_JSON_MAX_DEPTH) {
+        _skip++;
+        _overflow = true;
+        _afterKey = false;
+        return *this;
+    }
+    if (!_item()) return *this;
+    _out->print(open);
+    uint32_t bit = 1UL << _depth;
+    if (array) _arrays |= bit;
+    else _arrays &= ~bit;
+    _items &= ~bit;
+    _depth++;
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::_end(char close) {
+    if (_skip) {
+        _skip--;
+        return *this;
+    }
+    if (_depth == 0 || !_out) return *this;
+    _depth--;
+    _afterKey = false;
+    _out->print(close);
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::beginObject() {
+    return _begin('{', false);
+}
+
+CLIJsonWriter& CLIJsonWriter::beginObject(size_t pairs) {
+    (void)pairs;
+    return _begin('{', false);
+}
+
+CLIJsonWriter& CLIJsonWriter::endObject() {
+    return _end('}');
+}
+
+CLIJsonWriter& CLIJsonWriter::beginArray() {
+    return _begin('[', true);
+}
+
+CLIJsonWriter& CLIJsonWriter::beginArray(size_t count) {
+    (void)count;
+    return _begin('[', true);
+}
+
+CLIJsonWriter& CLIJsonWriter::endArray() {
+    return _end(']');
+}
+
+CLIJsonWriter& CLIJsonWriter::end() {
+    while (_skip) _skip--;
+    if (_afterKey) null(); /* A member cut short after its name */
+    while (_depth) _end((_arrays & (1UL << (_depth - 1))) ? ']' : '}');
+    return *this;
+}
+
+/* Quotes and escapes; control characters become \uXXXX */
+void CLIJsonWriter::_string(const char* s, bool flash) {
+    _out->print('"');
+    while (true) {
+        char c = flash ? (char)pgm_read_byte(s) : *s;
+        if (c == '\0') break;
+        s++;
+        if (c == '"' || c == '\\') {
+            _out->print('\\');
+            _out->print(c);
+        } else if (c == '\n') {
+            _out->print(F("\\n"));
+        } else if (c == '\r') {
+            _out->print(F("\\r"));
+        } else if (c == '\t') {
+            _out->print(F("\\t"));
+        } else if ((uint8_t)c < 0x20) {
+            uint8_t lo = (uint8_t)c & 0x0F;
+            _out->print(F("\\u00"));
+            _out->print((char)('0' + ((uint8_t)c >> 4)));
+            _out->print((char)(lo < 10 ? '0' + lo : 'a' + lo - 10));
+        } else {
+            _out->print(c);
+        }
+    }
+    _out->print('"');
+}
+
+CLIJsonWriter& CLIJsonWriter::key(const char* name) {
+    if (_depth == 0 || (_arrays & (1UL << (_depth - 1))) || !_item()) return *this;
+    _string(name ? name : "", false);
+    _out->print(':');
+    _afterKey = true;
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::key(const __FlashStringHelper* name) {
+    if (_depth == 0 || (_arrays & (1UL << (_depth - 1))) || !_item()) return *this;
+    _string((const char*)name, true);
+    _out->print(':');
+    _afterKey = true;
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::value(const char* s) {
+    if (!s) return null();
+    if (_item()) _string(s, false);
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::value(const __FlashStringHelper* s) {
+    if (!s) return null();
+    if (_item()) _string((const char*)s, true);
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::value(bool b) {
+    if (_item()) _out->print(b ? F("true") : F("false"));
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::value(int n) {
+    if (_item()) _out->print(n);
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::value(unsigned int n) {
+    if (_item()) _out->print(n);
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::value(long n) {
+    if (_item()) _out->print(n);
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::value(unsigned long n) {
+    if (_item()) _out->print(n);
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::value(double d, uint8_t digits) {
+    /* Print::print(double) writes "nan", "inf" or "ovf" (beyond +-4294967040), none of them JSON */
+    if (isnan(d) || isinf(d) || d > 4294967040.0 || d < -4294967040.0) return null();
+    if (_item()) _out->print(d, digits);
+    return *this;
+}
+
+CLIJsonWriter& CLIJsonWriter::null() {
+    if (_item()) _out->print(F("null"));
+    return *this;
+}
@@ -0,0 +1,151 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Streaming JSON writer for command output.                             *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIJson.h
+ * \brief Defines the CLIJsonWriter class returned by ArduinoCLI::json().
+ */
+#ifndef CLIJson_h
+#define CLIJson_h
+
+#include <Arduino.h>
+
+#ifndef CLI_JSON_MAX_DEPTH
+#define CLI_JSON_MAX_DEPTH 8        /**< Maximum nesting of objects and arrays (at most 32). */
+#endif
+
+/**
+ * @class CLIJsonWriter
+ * @brief Writes JSON straight to a Print as it is produced: no DOM, no heap.
+ *
+ * Commas, quotes and escapes are added by the writer:
+ *
+ *     cli->json().beginObject().key("temp").value(23.5).key("ok").value(true).endObject();
+ *
+ * Nesting deeper than CLI_JSON_MAX_DEPTH is dropped, contents included, and
+ * overflowed() reports it. A document starts with the first call after the previous
+ * one was closed.
+ */
+class CLIJsonWriter {
+public:
+    /**
+     * @brief Constructor for the CLIJsonWriter class.
+     * @param out Destination, or NULL until setOutput() is called.
+     */
+    explicit CLIJsonWriter(Print* out = nullptr);
+
+    /**
+     * @brief Changes the destination; the nesting state is kept.
+     * @param out Destination.
+     */
+    void setOutput(Print* out);
+
+    /** @brief Starts an object ('{'). */
+    CLIJsonWriter& beginObject();
+    /** @brief Starts an object; the count is ignored (see CLICborWriter). */
+    CLIJsonWriter& beginObject(size_t pairs);
+    /** @brief Ends the innermost object ('}'). */
+    CLIJsonWriter& endObject();
+    /** @brief Starts an array ('['). */
+    CLIJsonWriter& beginArray();
+    /** @brief Starts an array; the count is ignored (see CLICborWriter). */
+    CLIJsonWriter& beginArray(size_t count);
+    /** @brief Ends the innermost array (']'). */
+    CLIJsonWriter& endArray();
+
+    /**
+     * @brief Writes a member name; the next call writes its value.
+     * @param name Member name (escaped as needed).
+     */
+    CLIJsonWriter& key(const char* name);
+    CLIJsonWriter& key(const __FlashStringHelper* name);
+
+    /**
+     * @brief Writes a value (a string, or null for a NULL pointer).
+     */
+    CLIJsonWriter& value(const char* s);
+    CLIJsonWriter& value(const __FlashStringHelper* s);
+    CLIJsonWriter& value(bool b);
+    CLIJsonWriter& value(int n);
+    CLIJsonWriter& value(unsigned int n);
+    CLIJsonWriter& value(long n);
+    CLIJsonWriter& value(unsigned long n);
+
+    /**
+     * @brief Writes a number; NaN and infinity become null.
+     * @param d The number.
+     * @param digits Digits after the decimal point.
+     */
+    CLIJsonWriter& value(double d, uint8_t digits = 2);
+
+    /** @brief Writes null. */
+    CLIJsonWriter& null();
+
+    /**
+     * @brief Closes every open object and array; a member name without a value gets null.
+     */
+    CLIJsonWriter& end();
+
+    /**
+     * @brief Forgets any open objects and arrays (a new document starts).
+     */
+    void reset();
+
+    /**
+     * @brief Gets the current nesting depth.
+     * @return Number of open objects and arrays.
+     */
+    uint8_t depth() const;
+
+    /**
+     * @brief Checks whether nesting deeper than CLI_JSON_MAX_DEPTH was dropped.
+     * @return true if output was dropped since the document started.
+     */
+    bool overflowed() const;
+
+private:
+    Print* _out;                /**< Destination. */
+    uint32_t _arrays;           /**< Bit per open level: 1 for an array, 0 for an object. */
+    uint32_t _items;            /**< Bit per open level: the level has an item (needs a comma). */
+    uint8_t _depth;             /**< Open levels that are written. */
+    uint8_t _skip;              /**< Open levels beyond CLI_JSON_MAX_DEPTH that are dropped. */
+    bool _afterKey;             /**< A key was written; its value comes next. */
+    bool _overflow;             /**< Output was dropped. */
+
+    /**
+     * @brief Writes the separator in front of a key or value.
+     * @return false if output is being dropped.
+     * @private
+     */
+    bool _item();
+
+    /**
+     * @brief Opens a level.
+     * @private
+     */
+    CLIJsonWriter& _begin(char open, bool array);
+
+    /**
+     * @brief Closes the innermost level.
+     * @private
+     */
+    CLIJsonWriter& _end(char close);
+
+    /**
+     * @brief Writes a quoted, escaped string; flash selects PROGMEM reads.
+     * @private
+     */
+    void _string(const char* s, bool flash);
+};
+
+#endif /* CLIJson_h */
@@ -0,0 +1,251 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Minimal OS abstraction (threads, events) for the CLI task mode.       *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIOS.h
+ * \brief Thread and event primitives for CLITask, backed by FreeRTOS or pthreads.
+ *
+ * The FreeRTOS backend is used on ESP32, or anywhere CLI_OS_FREERTOS is defined (e.g.,
+ * RP2040 sketches using FreeRTOS). Linux hosts use pthreads. CLI_OS_AVAILABLE is
+ * defined when a backend was selected.
+ */
+#ifndef CLIOS_h
+#define CLIOS_h
+
+#include <stdint.h>
+
+#if !defined(CLI_OS_FREERTOS) && !defined(CLI_OS_PTHREADS)
+#if defined(ESP_PLATFORM) || defined(ARDUINO_ARCH_ESP32)
+#define CLI_OS_FREERTOS 1
+#elif defined(__linux__)
+#define CLI_OS_PTHREADS 1
+#endif
+#endif
+
+#define CLI_OS_WAIT_FOREVER 0xFFFFFFFFUL /**< Timeout value that never expires. */
+
+#if defined(CLI_OS_FREERTOS)
+
+#define CLI_OS_AVAILABLE 1
+
+#if defined(ESP_PLATFORM) || defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <task.h>
+#endif
+
+/**
+ * @class CLIOSEvent
+ * @brief Auto-reset event: signals are latched until one wait() consumes them.
+ */
+class CLIOSEvent {
+public:
+    CLIOSEvent() : _sem(xSemaphoreCreateBinary()) {}
+    ~CLIOSEvent() { if (_sem) vSemaphoreDelete(_sem); }
+
+    void signal() { xSemaphoreGive(_sem); }
+
+    void signalFromISR() {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(_sem, &woken);
+        if (woken) portYIELD_FROM_ISR();
+    }
+
+    /* Returns false on timeout */
+    bool wait(uint32_t timeoutMs) {
+        TickType_t ticks = (timeoutMs == CLI_OS_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+        return xSemaphoreTake(_sem, ticks) == pdTRUE;
+    }
+
+private:
+    SemaphoreHandle_t _sem;
+};
+
+/**
+ * @class CLIOSThread
+ * @brief Joinable task. Priority uses the FreeRTOS scale; the stack size is in bytes.
+ */
+class CLIOSThread {
+public:
+    CLIOSThread() : _entry(nullptr), _arg(nullptr), _running(false) {}
+
+    bool start(void (*entry)(void*), void* arg, const char* name, uint32_t stackBytes, int priority) {
+        if (_running) return false;
+        _entry = entry;
+        _arg = arg;
+        TaskHandle_t handle;
+        /* xTaskCreate counts words on vanilla FreeRTOS, bytes on ESP-IDF */
+#if defined(ESP_PLATFORM) || defined(ARDUINO_ARCH_ESP32)
+        uint32_t depth = stackBytes;
+#else
+        uint32_t depth = stackBytes / sizeof(StackType_t);
+#endif
+        _running = (xTaskCreate(&CLIOSThread::_trampoline, name, depth, this,
+                                (UBaseType_t)priority, &handle) == pdPASS);
+        return _running;
+    }
+
+    /* Waits for the entry function to return */
+    void join() {
+        if (!_running) return;
+        _exited.wait(CLI_OS_WAIT_FOREVER);
+        _running = false;
+    }
+
+private:
+    void (*_entry)(void*);
+    void* _arg;
+    bool _running;
+    CLIOSEvent _exited;
+
+    static void _trampoline(void* self) {
+        CLIOSThread* t = (CLIOSThread*)self;
+        t->_entry(t->_arg);
+        t->_exited.signal();
+        vTaskDelete(NULL); /* FreeRTOS tasks must not return */
+    }
+};
+
+#elif defined(CLI_OS_PTHREADS)
+
+#define CLI_OS_AVAILABLE 1
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+
+/**
+ * @class CLIOSEvent
+ * @brief Auto-reset event: signals are latched until one wait() consumes them.
+ */
+class CLIOSEvent {
+public:
+    CLIOSEvent() : _set(false) {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&_cond, &attr);
+        pthread_condattr_destroy(&attr);
+        pthread_mutex_init(&_lock, NULL);
+    }
+
+    ~CLIOSEvent() {
+        pthread_cond_destroy(&_cond);
+        pthread_mutex_destroy(&_lock);
+    }
+
+    void signal() {
+        pthread_mutex_lock(&_lock);
+        _set = true;
+        pthread_mutex_unlock(&_lock);
+        pthread_cond_signal(&_cond);
+    }
+
+    /* No interrupts on a host: same as signal() (not async-signal-safe) */
+    void signalFromISR() { signal(); }
+
+    /* Returns false on timeout */
+    bool wait(uint32_t timeoutMs) {
+        pthread_mutex_lock(&_lock);
+        if (timeoutMs == CLI_OS_WAIT_FOREVER) {
+            while (!_set) pthread_cond_wait(&_cond, &_lock);
+        } else {
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += timeoutMs / 1000;
+            deadline.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            while (!_set) {
+                if (pthread_cond_timedwait(&_cond, &_lock, &deadline) == ETIMEDOUT) break;
+            }
+        }
+        bool signalled = _set;
+        _set = false;
+        pthread_mutex_unlock(&_lock);
+        return signalled;
+    }
+
+private:
+    pthread_mutex_t _lock;
+    pthread_cond_t _cond;
+    bool _set;
+};
+
+/**
+ * @class CLIOSThread
+ * @brief Joinable thread. The priority is only applied when the process may use
+ * SCHED_FIFO (e.g., root); otherwise the default scheduler is used.
+ */
+class CLIOSThread {
+public:
+    CLIOSThread() : _running(false) {}
+
+    bool start(void (*entry)(void*), void* arg, const char* name, uint32_t stackBytes, int priority) {
+        if (_running) return false;
+        _entry = entry;
+        _arg = arg;
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if (stackBytes < PTHREAD_STACK_MIN) stackBytes = PTHREAD_STACK_MIN;
+        pthread_attr_setstacksize(&attr, stackBytes);
+        if (priority > 0) {
+            struct sched_param param;
+            param.sched_priority = priority;
+            pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+            pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+            pthread_attr_setschedparam(&attr, &param);
+        }
+        int rc = pthread_create(&_thread, &attr, &CLIOSThread::_trampoline, this);
+        if (rc == EPERM) {
+            /* No real-time privileges: fall back to the default scheduler */
+            pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+            rc = pthread_create(&_thread, &attr, &CLIOSThread::_trampoline, this);
+        }
+        pthread_attr_destroy(&attr);
+        (void)name;
+        _running = (rc == 0);
+        return _running;
+    }
+
+    /* Waits for the entry function to return */
+    void join() {
+        if (!_running) return;
+        pthread_join(_thread, NULL);
+        _running = false;
+    }
+
+private:
+    pthread_t _thread;
+    void (*_entry)(void*);
+    void* _arg;
+    bool _running;
+
+    static void* _trampoline(void* self) {
+        CLIOSThread* t = (CLIOSThread*)self;
+        t->_entry(t->_arg);
+        return NULL;
+    }
+};
+
+#endif /* backend */
+
+#endif /* CLIOS_h */
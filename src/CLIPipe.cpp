@@ -0,0 +1,74 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Bounded in-memory Stream carrying output between pipeline stages.     *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIPipe.cpp
+ * \brief Implements the CLIPipe class.
+ */
+
+#include "CLIPipe.h"
+
+CLIPipe::CLIPipe(char* buffer, size_t size, ArduinoCLI* writer) :
+    _buffer(buffer),
+    _size(buffer ? size : 0),
+    _head(0),
+    _count(0),
+    _overflow(false),
+    _writer(writer)
+{
+}
+
+int CLIPipe::available() {
+    return (int)_count;
+}
+
+int CLIPipe::read() {
+    if (_count == 0) return -1;
+    uint8_t c = (uint8_t)_buffer[_head];
+    _head = (_head + 1 == _size) ? 0 : _head + 1;
+    _count--;
+    return c;
+}
+
+int CLIPipe::peek() {
+    return _count ? (uint8_t)_buffer[_head] : -1;
+}
+
+size_t CLIPipe::write(uint8_t c) {
+    if (_count == _size) {
+        if (!_overflow && _writer) _writer->cancel(); /* Stop a long producer early */
+        _overflow = true;
+        return 0;
+    }
+    size_t tail = _head + _count;
+    if (tail >= _size) tail -= _size;
+    _buffer[tail] = (char)c;
+    _count++;
+    return 1;
+}
+
+size_t CLIPipe::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (n < size && write(buffer[n])) n++;
+    return n;
+}
+
+void CLIPipe::clear() {
+    _head = 0;
+    _count = 0;
+    _overflow = false;
+}
+
+bool CLIPipe::overflowed() const {
+    return _overflow;
+}
@@ -0,0 +1,68 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Bounded in-memory Stream carrying output between pipeline stages.     *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIPipe.h
+ * \brief Defines the CLIPipe class used for 'a | b' command lines.
+ */
+#ifndef CLIPipe_h
+#define CLIPipe_h
+
+#include "ArduinoCLI.h"
+
+/**
+ * @class CLIPipe
+ * @brief Ring buffer Stream: written by one pipeline stage, read by the next.
+ *
+ * When the ring is full, further output is dropped, the pipe is marked as overflowed
+ * and the writing session is cancelled, so handlers that call checkpoint() stop early.
+ */
+class CLIPipe : public Stream {
+public:
+    /**
+     * @brief Constructor for the CLIPipe class.
+     * @param buffer Caller-provided storage.
+     * @param size Size of buffer in bytes.
+     * @param writer Session to cancel when the pipe fills, or NULL.
+     */
+    CLIPipe(char* buffer, size_t size, ArduinoCLI* writer = nullptr);
+
+    /* Stream / Print interface */
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    /**
+     * @brief Empties the pipe and clears the overflow flag.
+     */
+    void clear();
+
+    /**
+     * @brief Checks whether output was dropped because the pipe was full.
+     * @return true if any write did not fit.
+     */
+    bool overflowed() const;
+
+private:
+    char* _buffer;              /**< Caller-provided storage. */
+    size_t _size;               /**< Capacity in bytes. */
+    size_t _head;               /**< Next byte to read. */
+    size_t _count;              /**< Bytes stored. */
+    bool _overflow;             /**< A write did not fit. */
+    ArduinoCLI* _writer;        /**< Session cancelled on overflow. */
+};
+
+#endif /* CLIPipe_h */
@@ -0,0 +1,237 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Host-only execution of text command files through mmap.               *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIRunFile.cpp
+ * \brief Implements ArduinoCLI::runFile() for Linux host builds.
+ */
+
+#include "ArduinoCLI.h"
+
+#ifdef CLI_HOST_SERVER
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Time spent in one command of the table */
+struct cli_timing {
+    unsigned long calls;
+    uint64_t totalNs;
+    uint64_t maxNs;
+};
+
+static uint64_t cli_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void cli_print_ms(Print& out, uint64_t ns) {
+    out.print((double)ns / 1e6, 3);
+    out.print(F(" ms"));
+}
+
+/* "path:line: " in front of an error message, as compilers do */
+static void cli_line_prefix(Print& out, const char* path, unsigned long lineNo) {
+    out.print(path);
+    out.print(':');
+    out.print(lineNo);
+    out.print(F(": "));
+}
+
+long ArduinoCLI::runFile(const char* path, uint8_t flags, Print* report) {
+    if (!path) return CLI_RUNFILE_ERR_OPEN;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return CLI_RUNFILE_ERR_OPEN;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return CLI_RUNFILE_ERR_OPEN;
+    }
+    size_t size = (size_t)st.st_size;
+    const char* text = nullptr;
+    if (size > 0) {
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            return CLI_RUNFILE_ERR_OPEN;
+        }
+        madvise(map, size, MADV_SEQUENTIAL);
+        text = (const char*)map;
+    }
+    close(fd); /* The mapping stays valid */
+
+    /* Lines are parsed in private storage: from a handler, _lineBuffer holds the caller's argv and chain */
+    char* buffer = (char*)malloc(_maxLineLen);
+    char** argv = (char**)malloc(_maxArgs * sizeof(char*));
+    if (!buffer || !argv) {
+        free(buffer);
+        free(argv);
+        if (text) munmap((void*)text, size);
+        return CLI_RUNFILE_ERR_OPEN;
+    }
+
+    _pinTable();
+    cli_timing* timings = nullptr;
+    if ((flags & CLI_RUNFILE_TIMINGS) && report) {
+        timings = (cli_timing*)calloc(_table->count(), sizeof(cli_timing));
+    }
+
+    /* Commands run inline; a dispatch hook would hand argv to another thread */
+    cli_dispatch_hook_t hook = _dispatchHook;
+    _dispatchHook = nullptr;
+
+    unsigned long lineNo = 0;
+    unsigned long commands = 0;
+    long failed = 0;
+    bool cancelled = false;
+    uint64_t start = cli_now_ns();
+    size_t pos = 0;
+
+    while (pos < size && _isRunning) {
+        const char* line = text + pos;
+        const char* end = (const char*)memchr(line, '\n', size - pos);
+        size_t len = end ? (size_t)(end - line) : size - pos;
+        pos += len + 1;
+        lineNo++;
+
+        /* Copy-on-parse: the tokenizer writes into buffer, never into the mapping */
+        bool ok = true;
+        const CLI_Command_t* cmd = NULL;
+        int argc = 0;
+        if (len >= _maxLineLen) {
+            cli_line_prefix(*_serial, path, lineNo);
+            _serial->println(F("Error: Line too long."));
+            ok = false;
+        } else {
+            memcpy(buffer, line, len);
+            buffer[len] = '\0';
+            char* s = buffer;
+            while (*s == ' ' || *s == '\t') s++;
+            if (*s == '#') continue; /* Comment */
+
+            /* Each line is one command, as in a compiled script */
+            argc = _splitSingle(s, argv, _maxArgs);
+            if (argc == 0) continue; /* Blank line */
+
+            int match_count = 0;
+            if (argc < 0) {
+                cli_line_prefix(*_serial, path, lineNo);
+                _serial->println(F("Error: Operators (; && || |) are not supported in files."));
+                ok = false;
+            } else if ((cmd = _findCommand(argv[0], &match_count)) == NULL) {
+                cli_line_prefix(*_serial, path, lineNo);
+                _serial->print(match_count > 1 ? F("Error: Ambiguous command '") : F("Error: Unknown command '"));
+                _serial->print(argv[0]);
+                _serial->println(F("'."));
+                ok = false;
+            } else if (argc - 1 > cmd->max_args) {
+                cli_line_prefix(*_serial, path, lineNo);
+                _serial->print(F("Error: Too many arguments for '"));
+                _serial->print(cmd->name);
+                _serial->println(F("'."));
+                ok = false;
+            }
+        }
+
+        if (!ok) {
+            failed++;
+            if (flags & CLI_RUNFILE_STOP_ON_ERROR) break;
+            continue;
+        }
+        if (cmd->func == NULL) continue;
+
+        _cancelled = false;
+        _checkpointCountdown = _checkpointInterval;
+        _resetWriters();
+        uint64_t t0 = timings ? cli_now_ns() : 0;
+        int status = cli_invoke(cmd, this, argc, argv);
+        if (timings) {
+            uint64_t ns = cli_now_ns() - t0;
+            cli_timing& t = timings[cmd - _table->command(0)];
+            t.calls++;
+            t.totalNs += ns;
+            if (ns > t.maxNs) t.maxNs = ns;
+        }
+        commands++;
+
+        /* Also look for Ctrl+C between commands that never call checkpoint() */
+        cancelled = _cancelled || ((commands & (CLI_DEFAULT_CHECKPOINT_INTERVAL - 1)) == 0 && isCancelled());
+        _endCommand();
+        if (cancelled) break;
+
+        if (status != CLI_STATUS_OK) {
+            cli_line_prefix(*_serial, path, lineNo);
+            _serial->print(F("Error: '"));
+            _serial->print(cmd->name);
+            _serial->print(F("' failed with status "));
+            _serial->print(status);
+            _serial->println('.');
+            failed++;
+            if (flags & CLI_RUNFILE_STOP_ON_ERROR) break;
+        }
+    }
+
+    uint64_t elapsed = cli_now_ns() - start;
+    _dispatchHook = hook;
+    if (text) munmap((void*)text, size);
+
+    if (report) {
+        report->print(path);
+        report->print(F(": "));
+        report->print(lineNo);
+        report->print(F(" lines, "));
+        report->print(commands);
+        report->print(F(" commands, "));
+        report->print(failed);
+        report->print(F(" failed"));
+        if (cancelled) report->print(F(", cancelled"));
+        report->print(F(" in "));
+        cli_print_ms(*report, elapsed);
+        if (elapsed > 0) {
+            report->print(F(" ("));
+            report->print((unsigned long)((double)lineNo * 1e9 / (double)elapsed));
+            report->print(F(" lines/s)"));
+        }
+        report->println();
+
+        for (size_t i = 0; timings && i < _table->count(); i++) {
+            const cli_timing& t = timings[i];
+            if (t.calls == 0) continue;
+            report->print(F("  "));
+            report->print(_table->command(i)->name);
+            report->print(F(": "));
+            report->print(t.calls);
+            report->print(F(" calls, total "));
+            cli_print_ms(*report, t.totalNs);
+            report->print(F(", avg "));
+            report->print((double)t.totalNs / t.calls / 1e3, 2);
+            report->print(F(" us, max "));
+            report->print((double)t.maxNs / 1e3, 2);
+            report->println(F(" us"));
+        }
+    }
+    free(timings);
+    free(argv);
+    free(buffer);
+    _unpinTable();
+    return failed;
+}
+
+#endif /* CLI_HOST_SERVER */
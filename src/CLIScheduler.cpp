@@ -0,0 +1,386 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Periodic ('every') and full-screen ('watch') commands on a timer      *
+ * wheel.                                                                *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIScheduler.cpp
+ * \brief Implements the CLIScheduler class and the built-in scheduler commands.
+ */
+
+#include "CLIScheduler.h"
+#include "CLIPipe.h"
+#include <string.h>
+#include <stdlib.h>
+
+#if (CLI_WHEEL_SLOTS & (CLI_WHEEL_SLOTS - 1)) != 0 || CLI_WHEEL_SLOTS > 256
+#error "CLI_WHEEL_SLOTS must be a power of two no larger than 256"
+#endif
+
+CLIScheduler::CLIScheduler(CLIJob jobs[], size_t maxJobs, uint16_t tickMs) :
+    _jobs(jobs),
+    _maxJobs(maxJobs > 255 ? 255 : maxJobs),
+    _tickMs(tickMs ? tickMs : 1),
+    _cursor(0),
+    _lastTick(0),
+    _active(0),
+    _due(nullptr),
+    _foreground(nullptr)
+{
+    for (size_t i = 0; i < CLI_WHEEL_SLOTS; i++) {
+        _wheel[i] = nullptr;
+    }
+    for (size_t i = 0; i < _maxJobs; i++) {
+        _jobs[i].id = 0;
+    }
+}
+
+/* --- Lists --- */
+
+void CLIScheduler::_link(CLIJob** head, CLIJob* job) {
+    job->next = *head;
+    job->pprev = head;
+    if (*head) (*head)->pprev = &job->next;
+    *head = job;
+}
+
+void CLIScheduler::_unlink(CLIJob* job) {
+    if (!job->pprev) return;
+    *job->pprev = job->next;
+    if (job->next) job->next->pprev = job->pprev;
+    job->next = nullptr;
+    job->pprev = nullptr;
+}
+
+/* Slot (cursor + ticks); a period of exactly one wheel turn lands on the cursor slot */
+void CLIScheduler::_schedule(CLIJob* job) {
+    uint8_t slot = (uint8_t)((_cursor + job->ticks) & (CLI_WHEEL_SLOTS - 1));
+    job->rounds = (uint16_t)((job->ticks - 1) / CLI_WHEEL_SLOTS);
+    _link(&_wheel[slot], job);
+}
+
+/* --- Job Management --- */
+
+uint8_t CLIScheduler::add(ArduinoCLI& cli, unsigned long periodMs, int argc, char *argv[], bool foreground) {
+    Stream& out = *cli._serial;
+
+    if (periodMs == 0 || argc < 1) {
+        out.println(F("Error: Usage: every <ms> <command> [args]"));
+        return 0;
+    }
+
+    CLIJob* job = nullptr;
+    for (size_t i = 0; i < _maxJobs; i++) {
+        if (_jobs[i].id == 0) {
+            job = &_jobs[i];
+            break;
+        }
+    }
+    if (!job) {
+        out.println(F("Error: Too many jobs."));
+        return 0;
+    }
+
+    /* Rejoin the arguments and prepare them once */
+    char line[CLI_PREPARED_LINE_LEN];
+    size_t len = 0;
+    for (int i = 0; i < argc; i++) {
+        size_t n = strlen(argv[i]);
+        if (len + n + 1 > sizeof(line)) {
+            len = sizeof(line);
+            break;
+        }
+        memcpy(line + len, argv[i], n);
+        len += n;
+        line[len++] = (i + 1 < argc) ? ' ' : '\0';
+    }
+    uint8_t status = (len > sizeof(line) - 1) ? CLI_PREPARE_TOO_LONG : cli.prepare(line, &job->command);
+    if (status == CLI_PREPARE_OK &&
+        (job->command.cmd->func == cli_every_handler || job->command.cmd->func == cli_watch_handler)) {
+        out.println(F("Error: Jobs cannot schedule other jobs."));
+        return 0;
+    }
+    switch (status) {
+        case CLI_PREPARE_OK:
+            break;
+        case CLI_PREPARE_AMBIGUOUS:
+        case CLI_PREPARE_UNKNOWN:
+            out.print(status == CLI_PREPARE_AMBIGUOUS ? F("Error: Ambiguous command '") : F("Error: Unknown command '"));
+            out.print(argv[0]);
+            out.println(F("'."));
+            return 0;
+        case CLI_PREPARE_TOO_MANY_ARGS:
+            out.print(F("Error: Too many arguments for '"));
+            out.print(argv[0]);
+            out.println(F("'."));
+            return 0;
+        case CLI_PREPARE_OPERATOR:
+            out.println(F("Error: A job runs a single command."));
+            return 0;
+        default:
+            out.println(F("Error: Command line too long for a job."));
+            return 0;
+    }
+
+    job->id = (uint8_t)(job - _jobs + 1);
+    job->period = periodMs;
+    unsigned long ticks = (periodMs + _tickMs - 1) / _tickMs;
+    job->ticks = (uint16_t)(ticks > 0xFFFF ? 0xFFFF : ticks);
+    job->foreground = foreground;
+    job->next = nullptr;
+    job->pprev = nullptr;
+
+    if (foreground) {
+        if (_foreground) cancel(_foreground->id); /* One screen owner at a time */
+        _foreground = job;
+    }
+    if (_active++ == 0) {
+        _lastTick = millis(); /* Wheel was idle: restart the clock */
+    }
+    _schedule(job);
+    return job->id;
+}
+
+bool CLIScheduler::cancel(uint8_t id) {
+    if (id == 0 || id > _maxJobs || _jobs[id - 1].id == 0) return false;
+    CLIJob* job = &_jobs[id - 1];
+    _unlink(job);
+    job->id = 0;
+    _active--;
+    if (_foreground == job) _foreground = nullptr;
+    return true;
+}
+
+void CLIScheduler::cancelAll() {
+    for (size_t i = 0; i < _maxJobs; i++) {
+        cancel((uint8_t)(i + 1));
+    }
+}
+
+size_t CLIScheduler::count() const {
+    return _active;
+}
+
+void CLIScheduler::list(Print& out) const {
+    if (_active == 0) {
+        out.println(F("No jobs."));
+        return;
+    }
+    for (size_t i = 0; i < _maxJobs; i++) {
+        const CLIJob& job = _jobs[i];
+        if (job.id == 0) continue;
+        out.print(F("  "));
+        out.print(job.id);
+        out.print(job.foreground ? F("  watch ") : F("  every "));
+        out.print(job.period);
+        out.print(F(" ms: "));
+        out.print(job.command.name);
+        for (uint8_t a = 1; a < job.command.argc; a++) {
+            out.print(' ');
+            out.print(job.command.argv[a]);
+        }
+        out.println();
+    }
+}
+
+template <class W>
+void CLIScheduler::_list(W& out) const {
+    out.beginObject(1).key(F("jobs")).beginArray(_active);
+    for (size_t i = 0; i < _maxJobs; i++) {
+        const CLIJob& job = _jobs[i];
+        if (job.id == 0) continue;
+        out.beginObject(4).key(F("id")).value(job.id).key(F("watch")).value(job.foreground)
+           .key(F("period")).value(job.period).key(F("command")).beginArray(job.command.argc);
+        out.value(job.command.name);
+        for (uint8_t a = 1; a < job.command.argc; a++) {
+            out.value(job.command.argv[a]);
+        }
+        out.endArray().endObject();
+    }
+    out.endArray().endObject();
+}
+
+void CLIScheduler::list(CLIJsonWriter& json) const {
+    _list(json);
+}
+
+void CLIScheduler::list(CLICborWriter& cbor) const {
+    _list(cbor);
+}
+
+/* --- Wheel --- */
+
+void CLIScheduler::_service(ArduinoCLI& cli) {
+    /* Any key ends a 'watch'; a host's requests do not */
+    if (_foreground && !cli._machineMode && !cli._binaryMode && cli._serial->available() > 0) {
+        cli._serial->read();
+        cancel(_foreground->id);
+        cli._printPrompt();
+        cli._serial->print(cli._lineBuffer);
+    }
+
+    unsigned long now = millis();
+    if (_active == 0) {
+        _lastTick = now;
+        return;
+    }
+
+    for (uint16_t n = 0; (unsigned long)(now - _lastTick) >= _tickMs; n++) {
+        if (n == CLI_WHEEL_SLOTS) {
+            _lastTick = now; /* Too far behind: skip the missed time */
+            break;
+        }
+        _lastTick += _tickMs;
+        _cursor = (uint8_t)((_cursor + 1) & (CLI_WHEEL_SLOTS - 1));
+
+        /* Move due jobs aside first; running one may cancel others */
+        CLIJob* job = _wheel[_cursor];
+        while (job) {
+            CLIJob* next = job->next;
+            if (job->rounds > 0) {
+                job->rounds--;
+            } else {
+                _unlink(job);
+                _link(&_due, job);
+            }
+            job = next;
+        }
+        while (_due) {
+            job = _due;
+            _unlink(job);
+            _schedule(job); /* Before running, so the job may cancel itself */
+            _run(cli, job);
+        }
+    }
+}
+
+/*
+ * On the console a job prints between prompts. In machine mode its output becomes a frame
+ * of its own, like a command's; binary replies only answer requests, so jobs wait there.
+ */
+void CLIScheduler::_run(ArduinoCLI& cli, CLIJob* job) {
+    if (cli._binaryMode) return; /* Rescheduled already: resumes on leaving binary mode */
+
+    Stream* console = cli._serial;
+    bool framed = cli._machineMode;
+    CLIPipe frame(cli._responseBuffer, cli._responseSize, &cli);
+    CLIPrintStream io(&frame, console); /* Input (Ctrl+C) still comes from the console */
+    const CLIPreparedCommand& command = job->command;
+
+    if (framed) {
+        cli._serial = &io;
+        cli._result = CLI_RESULT_OK;
+    } else {
+        if (job->foreground) {
+            console->print(F("\x1b[2J\x1b[H")); /* Clear screen, cursor home */
+            console->print(F("Every "));
+            console->print(job->period);
+            console->print(F(" ms: "));
+            console->print(command.name);
+            for (uint8_t a = 1; a < command.argc; a++) {
+                console->print(' ');
+                console->print(command.argv[a]);
+            }
+            console->println(F("  (any key stops)"));
+        }
+        console->println();
+    }
+
+    /* Only Ctrl+C may be taken from the input; a partly typed line stays in the Stream */
+    char* queue = cli._queue;
+    cli._queue = nullptr;
+    cli._pinTable();
+    bool ran = cli._runPrepared(&job->command);
+    cli._queue = queue;
+
+    bool cancelled = ran && cli._cancelled;
+    if (ran) cli._endCommand();
+    cli._unpinTable();
+    if (!ran) {
+        cli._serial->print(F("Job "));
+        cli._serial->print(job->id);
+        cli._serial->println(F(" stopped: command was removed."));
+    }
+    if (!ran || cancelled) cancel(job->id); /* Ctrl+C stops the job */
+
+    if (framed) {
+        cli._serial = console;
+        uint8_t result = !ran ? CLI_RESULT_UNKNOWN : frame.overflowed() ? CLI_RESULT_OVERFLOW : cli._result;
+        const char* id = cli._requestId;
+        cli._requestId = nullptr; /* Not a reply to any request */
+        cli._writeFrame(result, (size_t)frame.available());
+        cli._requestId = id;
+    } else if (!job->foreground || !ran || cancelled) {
+        cli._printPrompt();
+        cli._serial->print(cli._lineBuffer);
+    }
+}
+
+/* --- Built-in Commands --- */
+
+static void cli_schedule(ArduinoCLI* cli, int argc, char *argv[], bool foreground) {
+    CLIScheduler* scheduler = cli->getScheduler();
+    if (!scheduler) {
+        cli->getSerial().println(F("Error: No scheduler."));
+        return;
+    }
+    unsigned long period = (argc > 1) ? strtoul(argv[1], NULL, 10) : 0;
+    uint8_t id = scheduler->add(*cli, period, argc - 2, argv + 2, foreground);
+    if (id != 0 && !foreground) {
+        cli->getSerial().print(F("Job "));
+        cli->getSerial().println(id);
+    }
+}
+
+void cli_every_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    cli_schedule(cli, argc, argv, false);
+}
+
+void cli_watch_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    cli_schedule(cli, argc, argv, true);
+}
+
+void cli_jobs_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    (void)argc; /* Unused */
+    (void)argv; /* Unused */
+    CLIScheduler* scheduler = cli->getScheduler();
+    if (cli->isCborMode()) {
+        if (scheduler) scheduler->list(cli->cbor());
+        else cli->cbor().beginObject(1).key(F("jobs")).beginArray(0).endArray().endObject();
+    } else if (cli->isJsonMode()) {
+        if (scheduler) scheduler->list(cli->json());
+        else cli->json().beginObject().key(F("jobs")).beginArray().endArray().endObject();
+        cli->getSerial().println();
+    } else if (scheduler) {
+        scheduler->list(cli->getSerial());
+    } else {
+        cli->getSerial().println(F("No jobs."));
+    }
+}
+
+void cli_cancel_handler(ArduinoCLI* cli, int argc, char *argv[]) {
+    CLIScheduler* scheduler = cli->getScheduler();
+    Stream& out = cli->getSerial();
+    if (!scheduler || argc < 2) {
+        out.println(F("Error: Usage: cancel <job|all>"));
+        return;
+    }
+    if (strcmp(argv[1], "all") == 0) {
+        scheduler->cancelAll();
+    } else {
+        int id = atoi(argv[1]);
+        if (id > 0 && id <= 255 && scheduler->cancel((uint8_t)id)) return;
+        out.print(F("Error: No job '"));
+        out.print(argv[1]);
+        out.println(F("'."));
+    }
+}
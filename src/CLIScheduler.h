@@ -0,0 +1,166 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Periodic ('every') and full-screen ('watch') commands on a timer      *
+ * wheel.                                                                *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIScheduler.h
+ * \brief Defines the CLIScheduler class and the built-in every/watch/jobs/cancel commands.
+ */
+#ifndef CLIScheduler_h
+#define CLIScheduler_h
+
+#include "ArduinoCLI.h"
+
+#ifndef CLI_WHEEL_SLOTS
+#define CLI_WHEEL_SLOTS 32          /**< Timer wheel slots (power of two). */
+#endif
+#define CLI_DEFAULT_TICK_MS 10      /**< Default timer wheel resolution in milliseconds. */
+
+/**
+ * @brief One scheduled command. Storage is provided by the caller, managed by the library.
+ */
+typedef struct CLIJob {
+    struct CLIJob* next;            /**< Next job in the same list. */
+    struct CLIJob** pprev;          /**< Link pointing at this job. */
+    CLIPreparedCommand command;     /**< Resolved command and argv. */
+    unsigned long period;           /**< Period in milliseconds. */
+    uint16_t ticks;                 /**< Period in wheel ticks. */
+    uint16_t rounds;                /**< Full wheel turns left before the job is due. */
+    uint8_t id;                     /**< Job number shown by 'jobs' (0 = free slot). */
+    bool foreground;                /**< Started by 'watch': owns the screen until a key is pressed. */
+} CLIJob;
+
+/* Built-in command handlers (see CLI_SCHEDULER_COMMANDS) */
+void cli_every_handler(ArduinoCLI* cli, int argc, char *argv[]);
+void cli_watch_handler(ArduinoCLI* cli, int argc, char *argv[]);
+void cli_jobs_handler(ArduinoCLI* cli, int argc, char *argv[]);
+void cli_cancel_handler(ArduinoCLI* cli, int argc, char *argv[]);
+
+/**
+ * @brief Command table entries for the scheduler commands; add them to a command array.
+ */
+#define CLI_SCHEDULER_COMMANDS \
+    {"every", cli_every_handler, CLI_PREPARED_MAX_ARGS + 2, "every <ms> <command> [args]", 0, NULL}, \
+    {"watch", cli_watch_handler, CLI_PREPARED_MAX_ARGS + 2, "watch <ms> <command> [args] (key stops)", 0, NULL}, \
+    {"jobs", cli_jobs_handler, 0, "List periodic commands", 0, NULL}, \
+    {"cancel", cli_cancel_handler, 1, "cancel <job|all>", 0, NULL}
+
+/**
+ * @class CLIScheduler
+ * @brief Runs pre-resolved commands periodically from ArduinoCLI::poll().
+ *
+ * Each job holds a CLIPreparedCommand (see ArduinoCLI::prepare()), so it is not parsed
+ * again. They hang off a hashed timer wheel: each tick visits one slot, so the
+ * cost per tick does not depend on the total number of jobs. Jobs run inline in poll()
+ * with the session's Stream as output; a partly typed line is reprinted afterwards.
+ * If poll() falls behind by more than one wheel turn, the missed time is skipped.
+ */
+class CLIScheduler {
+public:
+    /**
+     * @brief Constructor for the CLIScheduler class.
+     * @param jobs Caller-provided job storage.
+     * @param maxJobs Number of entries in jobs (max 255).
+     * @param tickMs Wheel resolution in milliseconds; periods are rounded up to it.
+     */
+    CLIScheduler(CLIJob jobs[], size_t maxJobs, uint16_t tickMs = CLI_DEFAULT_TICK_MS);
+
+    /**
+     * @brief Schedules a command line that was already split into arguments.
+     * @param cli The session used to resolve the command.
+     * @param periodMs Period in milliseconds (> 0).
+     * @param argc Argument count (including command name).
+     * @param argv Argument vector; copied.
+     * @param foreground true for 'watch' behavior (clear screen, stop on any key).
+     * @return The job number, or 0 on error (message printed to the session).
+     */
+    uint8_t add(ArduinoCLI& cli, unsigned long periodMs, int argc, char *argv[], bool foreground = false);
+
+    /**
+     * @brief Cancels a job.
+     * @param id Job number.
+     * @return false if no such job.
+     */
+    bool cancel(uint8_t id);
+
+    /**
+     * @brief Cancels all jobs.
+     */
+    void cancelAll();
+
+    /**
+     * @brief Prints the job list.
+     * @param out Destination.
+     */
+    void list(Print& out) const;
+
+    /**
+     * @brief Writes the job list as {"jobs":[{"id":..,"watch":..,"period":..,"command":[..]},...]}.
+     * @param json The writer (see ArduinoCLI::json()).
+     */
+    void list(CLIJsonWriter& json) const;
+
+    /**
+     * @brief Writes the job list as CBOR, with the same structure as in JSON.
+     * @param cbor The encoder (see ArduinoCLI::cbor()).
+     */
+    void list(CLICborWriter& cbor) const;
+
+    /**
+     * @brief Gets the number of scheduled jobs.
+     * @return Jobs in use.
+     */
+    size_t count() const;
+
+private:
+    friend class ArduinoCLI;
+
+    CLIJob* _jobs;                  /**< Caller-provided job storage. */
+    size_t _maxJobs;                /**< Entries in _jobs. */
+    uint16_t _tickMs;               /**< Wheel resolution. */
+    uint8_t _cursor;                /**< Slot of the current tick. */
+    unsigned long _lastTick;        /**< millis() of the current tick. */
+    uint8_t _active;                /**< Jobs in use. */
+    CLIJob* _wheel[CLI_WHEEL_SLOTS]; /**< Jobs per slot. */
+    CLIJob* _due;                   /**< Jobs due on the tick being processed. */
+    CLIJob* _foreground;            /**< Running 'watch' job, or NULL. */
+
+    /**
+     * @brief Advances the wheel to millis() and runs due jobs. Called by ArduinoCLI::poll().
+     * @private
+     */
+    void _service(ArduinoCLI& cli);
+
+    /**
+     * @brief Places a job ticks ahead of the cursor.
+     * @private
+     */
+    void _schedule(CLIJob* job);
+
+    /**
+     * @brief Runs a job on the session.
+     * @private
+     */
+    void _run(ArduinoCLI& cli, CLIJob* job);
+
+    /**
+     * @brief Writes the job list with a CLIJsonWriter or CLICborWriter.
+     * @private
+     */
+    template <class W> void _list(W& out) const;
+
+    static void _link(CLIJob** head, CLIJob* job);   /**< @private */
+    static void _unlink(CLIJob* job);                /**< @private */
+};
+
+#endif /* CLIScheduler_h */
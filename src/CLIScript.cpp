@@ -0,0 +1,237 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Compiled script format: compiler and executor.                        *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIScript.cpp
+ * \brief Implements ArduinoCLI::compileScript() and ArduinoCLI::runScript().
+ *
+ * Compiled script layout (multi-byte values little-endian):
+ *
+ *     'C' 'L' 'S' version:u8  tableHash:u32  recordCount:u16
+ *     record*:  commandIndex:u16  argc:u8  { len:u8  bytes[len]  0 } * argc
+ *
+ * commandIndex is the position in the CLI_Command_t array and argc
+ * excludes the command name. Each argument keeps its NUL terminator, so
+ * the executor copies a record's arguments into a CLI_SCRIPT_LINE_LEN
+ * buffer as they are; nothing is tokenized. tableHash is
+ * CLICommandTable::hash(); reordering, renaming or changing argument
+ * limits of commands invalidates compiled scripts.
+ * extras/host/cli_scriptc.cpp produces the same format on a PC.
+ */
+
+#include "ArduinoCLI.h"
+#include <string.h>
+
+#ifndef CLI_SCRIPT_LINE_LEN
+#define CLI_SCRIPT_LINE_LEN CLI_DEFAULT_MAX_LINE_LEN
+#endif
+
+static uint16_t cli_get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t cli_get32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void cli_script_error(Print* errors, unsigned lineNo, const __FlashStringHelper* msg, const char* what) {
+    if (!errors) return;
+    errors->print(F("Line "));
+    errors->print(lineNo);
+    errors->print(F(": "));
+    errors->print(msg);
+    if (what) {
+        errors->print(F(" '"));
+        errors->print(what);
+        errors->print('\'');
+    }
+    errors->println('.');
+}
+
+/* Walks all records without running them; true if every one is in bounds and valid */
+static bool cli_script_check(const uint8_t* script, size_t len, const CLICommandTable* table, uint16_t records) {
+    size_t pos = CLI_SCRIPT_HEADER_LEN;
+    for (uint16_t r = 0; r < records; r++) {
+        if (len - pos < 3) return false;
+        const CLI_Command_t* cmd = table->command(cli_get16(script + pos));
+        uint8_t argc = script[pos + 2];
+        pos += 3;
+        if (cmd == NULL || cmd->name == NULL || argc > cmd->max_args || argc > CLI_SCRIPT_MAX_ARGS) return false;
+
+        size_t bytes = 0; /* Arguments with terminators, as copied by the executor */
+        for (uint8_t a = 0; a < argc; a++) {
+            if (len - pos < 2) return false;
+            size_t n = script[pos];
+            if (len - pos < n + 2 || script[pos + 1 + n] != '\0') return false;
+            bytes += n + 1;
+            pos += n + 2;
+        }
+        if (bytes > CLI_SCRIPT_LINE_LEN) return false;
+    }
+    return true;
+}
+
+/* --- Compiler --- */
+
+long ArduinoCLI::compileScript(const char* text, uint8_t* out, size_t outSize, Print* errors) {
+    if (!text || !out) return CLI_SCRIPT_ERR_FORMAT;
+    if (outSize < CLI_SCRIPT_HEADER_LEN) return CLI_SCRIPT_ERR_SPACE;
+
+    _pinTable();
+    long result = 0;
+    size_t pos = CLI_SCRIPT_HEADER_LEN;
+    uint16_t records = 0;
+    unsigned lineNo = 0;
+    const char* p = text;
+
+    while (*p && result == 0) {
+        lineNo++;
+        const char* end = strchr(p, '\n');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        char line[CLI_SCRIPT_LINE_LEN];
+        if (len >= sizeof(line)) {
+            cli_script_error(errors, lineNo, F("Line too long"), NULL);
+            result = CLI_SCRIPT_ERR_LINE;
+            break;
+        }
+        memcpy(line, p, len);
+        line[len] = '\0';
+        p += len + (end ? 1 : 0);
+
+        char* s = line;
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '#') continue; /* Comment */
+
+        /* One spare slot detects lines with too many arguments; a record holds one command */
+        char* argv[CLI_SCRIPT_MAX_ARGS + 3];
+        int argc = _splitSingle(s, argv, CLI_SCRIPT_MAX_ARGS + 3);
+        if (argc < 0) {
+            cli_script_error(errors, lineNo, F("Operators (; && || |) are not supported"), NULL);
+            result = CLI_SCRIPT_ERR_LINE;
+            break;
+        }
+        if (argc == 0) continue; /* Blank line */
+
+        int match_count = 0;
+        const CLI_Command_t* cmd = _findCommand(argv[0], &match_count);
+        if (cmd == NULL) {
+            cli_script_error(errors, lineNo,
+                             match_count > 1 ? F("Ambiguous command") : F("Unknown command"), argv[0]);
+            result = CLI_SCRIPT_ERR_LINE;
+            break;
+        }
+        if (argc - 1 > cmd->max_args || argc - 1 > CLI_SCRIPT_MAX_ARGS) {
+            cli_script_error(errors, lineNo, F("Too many arguments for"), cmd->name);
+            result = CLI_SCRIPT_ERR_LINE;
+            break;
+        }
+        if (records == 0xFFFF) {
+            cli_script_error(errors, lineNo, F("Too many commands"), NULL);
+            result = CLI_SCRIPT_ERR_LINE;
+            break;
+        }
+
+        size_t need = 3;
+        for (int i = 1; i < argc; i++) {
+            need += strlen(argv[i]) + 2; /* Length byte and terminator; strings fit the line buffer */
+        }
+        if (pos + need > outSize) {
+            result = CLI_SCRIPT_ERR_SPACE;
+            break;
+        }
+
+        size_t index = (size_t)(cmd - _table->command(0));
+        out[pos++] = (uint8_t)index;
+        out[pos++] = (uint8_t)(index >> 8);
+        out[pos++] = (uint8_t)(argc - 1);
+        for (int i = 1; i < argc; i++) {
+            size_t n = strlen(argv[i]);
+            out[pos++] = (uint8_t)n;
+            memcpy(out + pos, argv[i], n + 1);
+            pos += n + 1;
+        }
+        records++;
+    }
+
+    if (result == 0) {
+        uint32_t h = _table->hash();
+        out[0] = 'C';
+        out[1] = 'L';
+        out[2] = 'S';
+        out[3] = CLI_SCRIPT_VERSION;
+        for (uint8_t b = 0; b < 4; b++) {
+            out[4 + b] = (uint8_t)(h >> (8 * b));
+        }
+        out[8] = (uint8_t)records;
+        out[9] = (uint8_t)(records >> 8);
+        result = (long)pos;
+    }
+    _unpinTable();
+    return result;
+}
+
+/* --- Executor --- */
+
+long ArduinoCLI::runScript(const uint8_t* script, size_t len) {
+    if (!script || len < CLI_SCRIPT_HEADER_LEN ||
+        script[0] != 'C' || script[1] != 'L' || script[2] != 'S' || script[3] != CLI_SCRIPT_VERSION) {
+        return CLI_SCRIPT_ERR_FORMAT;
+    }
+
+    _pinTable();
+    if (cli_get32(script + 4) != _table->hash()) {
+        _unpinTable();
+        return CLI_SCRIPT_ERR_TABLE;
+    }
+    uint16_t records = cli_get16(script + 8);
+
+    /* Pass 1: bounds and limits only, so a damaged script runs nothing */
+    if (!cli_script_check(script, len, _table, records)) {
+        _unpinTable();
+        return CLI_SCRIPT_ERR_FORMAT;
+    }
+
+    /* Pass 2: run, with argv pointing into a writable copy of each record's arguments */
+    long executed = 0;
+    size_t pos = CLI_SCRIPT_HEADER_LEN;
+    for (uint16_t r = 0; r < records; r++) {
+        const CLI_Command_t* cmd = _table->command(cli_get16(script + pos));
+        uint8_t argc = script[pos + 2];
+        pos += 3;
+
+        char line[CLI_SCRIPT_LINE_LEN];
+        char* argv[CLI_SCRIPT_MAX_ARGS + 2];
+        size_t used = 0;
+        argv[0] = (char*)cmd->name;
+        for (uint8_t a = 0; a < argc; a++) {
+            size_t n = script[pos] + 1;
+            memcpy(line + used, script + pos + 1, n);
+            argv[a + 1] = line + used;
+            used += n;
+            pos += n + 1;
+        }
+        argv[argc + 1] = NULL;
+
+        if (cmd->func == NULL) continue;
+        _cancelled = false;
+        _checkpointCountdown = _checkpointInterval;
+        _resetWriters();
+        cli_invoke(cmd, this, argc + 1, argv);
+        executed++;
+        bool cancelled = _cancelled;
+        _endCommand();
+        if (cancelled) break; /* Ctrl+C aborts the rest of the script */
+    }
+    _unpinTable();
+    return executed;
+}
@@ -0,0 +1,203 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Multi-session manager: one command table, many Streams.               *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLISessionManager.h
+ * \brief Defines the CLISessionManager template for serving one command set on several Streams.
+ */
+#ifndef CLISessionManager_h
+#define CLISessionManager_h
+
+#include "ArduinoCLI.h"
+
+#define CLI_DEFAULT_SESSION_BYTE_BUDGET 32 /**< Default input bytes a session may consume per poll(). */
+
+/**
+ * @class CLISessionManager
+ * @brief Serves a single command table on up to MAX_SESSIONS Streams.
+ *
+ * The command table and its lookup index are built once and shared, and so is one
+ * ArduinoCLI instance that parses and dispatches for every session (see cli()). Each
+ * attached Stream only gets a CLISessionState from a fixed pool with its own line buffer,
+ * argv, prompt and editing state; no heap is used per session. poll() loads each session
+ * into the shared instance in turn, round-robin, each limited to a byte budget per call
+ * so a busy link cannot starve the others.
+ *
+ * @tparam MAX_SESSIONS Number of sessions in the pool.
+ * @tparam LINE_LEN Line buffer size per session.
+ * @tparam MAX_ARGS Maximum number of arguments (excluding command name) per session.
+ */
+template <size_t MAX_SESSIONS, size_t LINE_LEN = CLI_DEFAULT_MAX_LINE_LEN, size_t MAX_ARGS = CLI_DEFAULT_MAX_ARGS>
+class CLISessionManager {
+public:
+    /**
+     * @brief Constructor for the CLISessionManager class.
+     * @param commands Pointer to an array of CLI_Command_t structures defining the available commands.
+     * @param commandCount The number of commands in the commands array.
+     */
+    CLISessionManager(const CLI_Command_t commands[], size_t commandCount) :
+        _table(commands, commandCount),
+        _next(0),
+        _byteBudget(CLI_DEFAULT_SESSION_BYTE_BUDGET)
+    {
+        _cli._table = &_table;
+        for (size_t i = 0; i < MAX_SESSIONS; i++) {
+            _release(i);
+        }
+    }
+
+    /**
+     * @brief Attaches a Stream to a free session and starts it (prints the first prompt).
+     * @param stream The Stream to serve (e.g., Serial1 or a connected Client).
+     * @param prompt Optional prompt for this session; CLI_DEFAULT_PROMPT if NULL.
+     * @return false if the pool is exhausted or the Stream is already attached.
+     */
+    bool attach(Stream& stream, const char* prompt = nullptr) {
+        if (isAttached(stream)) return false;
+        for (size_t i = 0; i < MAX_SESSIONS; i++) {
+            if (_sessions[i]._serial) continue;
+            _sessions[i]._serial = &stream;
+            _cli._loadSession(_sessions[i]);
+            _cli.setPrompt(prompt);
+            _cli.start();
+            _cli._saveSession(_sessions[i]);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Detaches a Stream and returns its session to the pool.
+     * @param stream The Stream to detach.
+     * @return true if the Stream had a session.
+     */
+    bool detach(Stream& stream) {
+        for (size_t i = 0; i < MAX_SESSIONS; i++) {
+            if (_sessions[i]._serial != &stream) continue;
+            _release(i);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Checks whether a Stream has a session.
+     * @param stream The Stream to look up.
+     * @return true if the Stream is attached.
+     */
+    bool isAttached(Stream& stream) const {
+        for (size_t i = 0; i < MAX_SESSIONS; i++) {
+            if (_sessions[i]._serial == &stream) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Gets the number of attached sessions.
+     * @return Number of sessions in use.
+     */
+    size_t activeSessions() const {
+        size_t n = 0;
+        for (size_t i = 0; i < MAX_SESSIONS; i++) {
+            if (_sessions[i]._serial) n++;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Sets how many input bytes each session may consume per poll().
+     * @param bytes Byte budget (must be > 0).
+     */
+    void setByteBudget(size_t bytes) {
+        if (bytes > 0) _byteBudget = bytes;
+    }
+
+    /**
+     * @brief Services every attached session once, round-robin.
+     * The session served first rotates on each call. Sessions that were stopped
+     * (e.g., by an 'exit' command) are returned to the pool.
+     */
+    void poll() {
+        for (size_t n = 0; n < MAX_SESSIONS; n++) {
+            size_t i = (_next + n) % MAX_SESSIONS;
+            if (!_sessions[i]._serial) continue;
+            _cli._loadSession(_sessions[i]);
+            _cli.poll(_byteBudget);
+            _cli._saveSession(_sessions[i]);
+            if (!_sessions[i]._isRunning) _release(i);
+        }
+        _next = (_next + 1) % MAX_SESSIONS;
+    }
+
+    /**
+     * @brief Resolves commands of every session through a runtime registry.
+     * The shared instance claims one reader slot.
+     * @param registry The registry (must outlive the manager), or NULL for the fixed table.
+     * @return false if the registry has no free reader slot.
+     */
+    bool setCommandRegistry(CLICommandRegistry* registry) {
+        return _cli.setCommandRegistry(registry);
+    }
+
+    /**
+     * @brief Gets the instance shared by all sessions.
+     * Settings made on it (output format, machine mode, history, queues, scheduler,
+     * buffers) apply to every Stream; the prompt is set per session by attach(). Handlers
+     * receive it with the session being served loaded, so getSerial() and stop() act on
+     * that session. Its dispatch hook must not defer commands.
+     * @return The shared ArduinoCLI.
+     */
+    ArduinoCLI& cli() {
+        return _cli;
+    }
+
+    /**
+     * @brief Gets the shared command table.
+     * @return Reference to the command table and lookup index.
+     */
+    const CLICommandTable& table() const {
+        return _table;
+    }
+
+    /**
+     * @brief Gets the RAM reserved per session.
+     * @return Bytes of the session state, its line buffer and its argv.
+     */
+    static constexpr size_t sessionBytes() {
+        return sizeof(CLISessionState) + LINE_LEN + (MAX_ARGS + 1) * sizeof(char*);
+    }
+
+private:
+    CLICommandTable _table;                 /**< Shared, immutable command table and index. */
+    ArduinoCLI _cli;                        /**< Shared instance; sessions are loaded into it. */
+    CLISessionState _sessions[MAX_SESSIONS]; /**< Session pool; unbound sessions have no Stream. */
+    char _lines[MAX_SESSIONS][LINE_LEN];    /**< Line buffer storage per session. */
+    char* _argv[MAX_SESSIONS][MAX_ARGS + 1]; /**< argv storage per session. */
+    size_t _next;                           /**< Session served first on the next poll(). */
+    size_t _byteBudget;                     /**< Input bytes per session per poll(). */
+
+    /**
+     * @brief Returns a session to the pool: no Stream, default prompt, empty line.
+     * @private
+     */
+    void _release(size_t i) {
+        _sessions[i] = CLISessionState();
+        _sessions[i]._lineBuffer = _lines[i];
+        _sessions[i]._maxLineLen = LINE_LEN;
+        _sessions[i]._argv = _argv[i];
+        _sessions[i]._maxArgs = MAX_ARGS + 1;
+        _lines[i][0] = '\0';
+    }
+};
+
+#endif /* CLISessionManager_h */
@@ -0,0 +1,145 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Runs an ArduinoCLI in its own RTOS task instead of loop().            *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLITask.cpp
+ * \brief Implements the CLITask class.
+ */
+
+#include "CLITask.h"
+
+#ifdef CLI_OS_AVAILABLE
+
+#include "CLIAtomic.h"
+
+CLITask::CLITask(ArduinoCLI& cli) :
+    _cli(cli),
+    _idleMs(CLI_TASK_DEFAULT_IDLE_MS),
+    _commandPriority(-1),
+    _commandStack(CLI_TASK_DEFAULT_STACK),
+    _stop(false),
+    _completed(false),
+    _running(false),
+    _cmd(nullptr),
+    _argc(0),
+    _argv(nullptr),
+    _status(CLI_STATUS_OK)
+{
+}
+
+CLITask::~CLITask() {
+    end();
+}
+
+void CLITask::setCommandTask(int priority, uint32_t stackBytes) {
+    _commandPriority = priority;
+    _commandStack = stackBytes;
+}
+
+void CLITask::setIdleTimeout(uint32_t ms) {
+    _idleMs = ms;
+}
+
+bool CLITask::begin(int priority, uint32_t stackBytes) {
+    if (_running) return false;
+    _stop = false;
+    _completed = false;
+
+    if (_commandPriority >= 0) {
+        if (!_commandThread.start(&CLITask::_commandMain, this, "cli_cmd", _commandStack, _commandPriority)) {
+            return false;
+        }
+        _cli.setDispatchHook(&CLITask::_dispatch, this);
+    }
+    if (!_ioThread.start(&CLITask::_ioMain, this, "cli", stackBytes, priority)) {
+        _cli.setDispatchHook(nullptr, nullptr);
+        cli_atomic_store(&_stop, true);
+        _commandReady.signal();
+        _commandThread.join();
+        return false;
+    }
+    _running = true;
+    return true;
+}
+
+void CLITask::end() {
+    if (!_running) return;
+    cli_atomic_store(&_stop, true);
+    _wake.signal();
+    _commandReady.signal();
+    _ioThread.join();
+    _commandThread.join();
+    _running = false;
+
+    /* Hand the CLI back in a usable state, e.g. for polling from loop() */
+    _cli.setDispatchHook(nullptr, nullptr);
+    if (cli_atomic_exchange(&_completed, false)) _cli.completeDispatch(_status);
+}
+
+void CLITask::notify() {
+    _wake.signal();
+}
+
+void CLITask::notifyFromISR() {
+    _wake.signalFromISR();
+}
+
+bool CLITask::inject(const char* line, Print* sink) {
+    if (!_cli.inject(line, sink)) return false;
+    _wake.signal();
+    return true;
+}
+
+/* I/O task: sleep until notified (or the idle timeout), then process everything available */
+void CLITask::_ioMain(void* self) {
+    CLITask* t = (CLITask*)self;
+    ArduinoCLI& cli = t->_cli;
+
+    cli.start();
+    while (!cli_atomic_load(&t->_stop)) {
+        if (cli_atomic_exchange(&t->_completed, false)) cli.completeDispatch(t->_status);
+        cli.poll();
+        t->_wake.wait(t->_idleMs);
+    }
+}
+
+/* Command task: run handed-over commands one at a time */
+void CLITask::_commandMain(void* self) {
+    CLITask* t = (CLITask*)self;
+
+    while (true) {
+        t->_commandReady.wait(CLI_OS_WAIT_FOREVER);
+
+        /* A command handed over just before end() still runs */
+        const CLI_Command_t* cmd = cli_atomic_exchange(&t->_cmd, (const CLI_Command_t*)nullptr);
+        if (cmd) {
+            t->_status = cli_invoke(cmd, &t->_cli, t->_argc, t->_argv);
+            cli_atomic_store(&t->_completed, true); /* Publishes _status */
+            t->_wake.signal();
+        }
+        if (cli_atomic_load(&t->_stop)) break;
+    }
+}
+
+/* Dispatch hook (I/O task): hand the command to the command task */
+bool CLITask::_dispatch(void* ctx, ArduinoCLI* cli, const CLI_Command_t* cmd, int argc, char *argv[]) {
+    (void)cli;
+    CLITask* t = (CLITask*)ctx;
+    t->_argc = argc;
+    t->_argv = argv;
+    cli_atomic_store(&t->_cmd, cmd); /* Publishes argc/argv */
+    t->_commandReady.signal();
+    return true;
+}
+
+#endif /* CLI_OS_AVAILABLE */
@@ -0,0 +1,127 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Runs an ArduinoCLI in its own RTOS task instead of loop().            *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLITask.h
+ * \brief Defines the CLITask class (dedicated task mode with blocking receive).
+ */
+#ifndef CLITask_h
+#define CLITask_h
+
+#include "ArduinoCLI.h"
+#include "CLIOS.h"
+
+#ifdef CLI_OS_AVAILABLE
+
+#ifndef CLI_TASK_DEFAULT_PRIORITY
+#if defined(CLI_OS_FREERTOS)
+#define CLI_TASK_DEFAULT_PRIORITY 1   /**< Just above the FreeRTOS idle task. */
+#else
+#define CLI_TASK_DEFAULT_PRIORITY 0   /**< Default (non real-time) scheduler. */
+#endif
+#endif
+#define CLI_TASK_DEFAULT_STACK 4096   /**< Default task stack size in bytes. */
+#define CLI_TASK_DEFAULT_IDLE_MS 20   /**< Default fallback poll interval when no notify() arrives. */
+
+/**
+ * @class CLITask
+ * @brief Runs an ArduinoCLI in a dedicated task that sleeps until input arrives.
+ *
+ * The task blocks on an event instead of busy-polling available(). Call notify() (or
+ * notifyFromISR()) whenever bytes arrive, e.g. from a UART receive callback; without a
+ * notification the task still checks the Stream every idle timeout.
+ *
+ * With setCommandTask(), handlers run in a second task at their own priority. The I/O task
+ * hands each command over through the dispatch hook and reads no input until the
+ * handler returns, so commands can run below (or above) the priority of console I/O.
+ */
+class CLITask {
+public:
+    /**
+     * @brief Constructor for the CLITask class.
+     * @param cli The CLI to run; must not be polled from anywhere else once begin() is called.
+     */
+    explicit CLITask(ArduinoCLI& cli);
+    ~CLITask();
+
+    /**
+     * @brief Runs command handlers in their own task. Call before begin().
+     * @param priority Task priority (FreeRTOS scale; SCHED_FIFO on pthreads if permitted).
+     * @param stackBytes Stack size in bytes.
+     */
+    void setCommandTask(int priority, uint32_t stackBytes = CLI_TASK_DEFAULT_STACK);
+
+    /**
+     * @brief Sets how long the task sleeps without a notification before checking the Stream.
+     * @param ms Timeout in milliseconds, or CLI_OS_WAIT_FOREVER to rely on notify() only.
+     */
+    void setIdleTimeout(uint32_t ms);
+
+    /**
+     * @brief Starts the CLI (prints the first prompt) in a new task.
+     * @param priority Task priority (FreeRTOS scale; SCHED_FIFO on pthreads if permitted).
+     * @param stackBytes Stack size in bytes.
+     * @return true if the task(s) were created.
+     */
+    bool begin(int priority = CLI_TASK_DEFAULT_PRIORITY, uint32_t stackBytes = CLI_TASK_DEFAULT_STACK);
+
+    /**
+     * @brief Stops the task(s) and waits for them. A running handler is finished first.
+     */
+    void end();
+
+    /**
+     * @brief Wakes the task because input may be available. Callable from any task.
+     */
+    void notify();
+
+    /**
+     * @brief Wakes the task from an interrupt handler.
+     */
+    void notifyFromISR();
+
+    /**
+     * @brief Injects a command line (see ArduinoCLI::inject()) and wakes the task.
+     * @param line The command line.
+     * @param sink Output destination, or NULL to discard.
+     * @return false if the line was not queued.
+     */
+    bool inject(const char* line, Print* sink = nullptr);
+
+private:
+    ArduinoCLI& _cli;               /**< The CLI served by the task. */
+    CLIOSThread _ioThread;          /**< Reads input, edits lines, resolves commands. */
+    CLIOSThread _commandThread;     /**< Runs handlers (setCommandTask() only). */
+    CLIOSEvent _wake;               /**< Input, injection or command completion. */
+    CLIOSEvent _commandReady;       /**< A command was handed to the command task. */
+    uint32_t _idleMs;               /**< Fallback poll interval. */
+    int _commandPriority;           /**< Command task priority, or -1 for none. */
+    uint32_t _commandStack;         /**< Command task stack size in bytes. */
+    volatile bool _stop;            /**< Asks the tasks to exit. */
+    volatile bool _completed;       /**< The command task finished a handler. */
+    bool _running;                  /**< begin() succeeded. */
+
+    /* Command handed to the command task */
+    const CLI_Command_t* volatile _cmd;
+    int _argc;
+    char** _argv;
+    int _status;                    /**< Its result, published by _completed. */
+
+    static void _ioMain(void* self);
+    static void _commandMain(void* self);
+    static bool _dispatch(void* ctx, ArduinoCLI* cli, const CLI_Command_t* cmd, int argc, char *argv[]);
+};
+
+#endif /* CLI_OS_AVAILABLE */
+
+#endif /* CLITask_h */
@@ -0,0 +1,152 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Host-only work-stealing thread pool for command handlers.             *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIWorkerPool.cpp
+ * \brief Implements the CLIWorkerPool class.
+ */
+
+#include "CLIWorkerPool.h"
+
+#ifdef CLI_HOST_SERVER
+
+CLIWorkerPool::CLIWorkerPool() :
+    _workers(nullptr),
+    _count(0),
+    _nextWorker(0),
+    _serialBusy(false),
+    _generation(0),
+    _running(false)
+{
+}
+
+CLIWorkerPool::~CLIWorkerPool() {
+    end();
+}
+
+bool CLIWorkerPool::begin(size_t threads) {
+    if (threads == 0 || _workers) return false;
+
+    _workers = new Worker[threads];
+    _count = threads;
+    _running = true;
+    for (size_t i = 0; i < threads; i++) {
+        _workers[i].thread = std::thread(&CLIWorkerPool::_workerMain, this, i);
+    }
+    return true;
+}
+
+void CLIWorkerPool::end() {
+    if (!_workers) return;
+    {
+        std::lock_guard<std::mutex> lk(_sleepLock);
+        _running = false;
+    }
+    _wake.notify_all();
+    for (size_t i = 0; i < _count; i++) {
+        _workers[i].thread.join();
+    }
+    delete[] _workers;
+    _workers = nullptr;
+    _count = 0;
+    _serialJobs.clear();
+    _serialBusy = false;
+}
+
+size_t CLIWorkerPool::threads() const {
+    return _count;
+}
+
+void CLIWorkerPool::submit(Job* job) {
+    if (job->serialized) {
+        std::lock_guard<std::mutex> lk(_serialLock);
+        _serialJobs.push_back(job);
+    } else {
+        /* Spread injected jobs; idle workers steal to rebalance */
+        Worker& w = _workers[_nextWorker.fetch_add(1) % _count];
+        std::lock_guard<std::mutex> lk(w.lock);
+        w.jobs.push_back(job);
+    }
+    {
+        std::lock_guard<std::mutex> lk(_sleepLock);
+        _generation++;
+    }
+    _wake.notify_one();
+}
+
+CLIWorkerPool::Job* CLIWorkerPool::_take(size_t self, bool* serialized) {
+    *serialized = false;
+
+    /* Own deque, newest first */
+    {
+        Worker& w = _workers[self];
+        std::lock_guard<std::mutex> lk(w.lock);
+        if (!w.jobs.empty()) {
+            Job* job = w.jobs.back();
+            w.jobs.pop_back();
+            return job;
+        }
+    }
+
+    /* Steal the oldest job from another worker */
+    for (size_t n = 1; n < _count; n++) {
+        Worker& victim = _workers[(self + n) % _count];
+        std::lock_guard<std::mutex> lk(victim.lock);
+        if (!victim.jobs.empty()) {
+            Job* job = victim.jobs.front();
+            victim.jobs.pop_front();
+            return job;
+        }
+    }
+
+    /* Serialized jobs, one at a time across the pool */
+    {
+        std::lock_guard<std::mutex> lk(_serialLock);
+        if (!_serialBusy && !_serialJobs.empty()) {
+            Job* job = _serialJobs.front();
+            _serialJobs.pop_front();
+            _serialBusy = true;
+            *serialized = true;
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void CLIWorkerPool::_workerMain(size_t self) {
+    while (true) {
+        unsigned long seen;
+        {
+            std::lock_guard<std::mutex> lk(_sleepLock);
+            if (!_running) return;
+            seen = _generation;
+        }
+
+        bool serialized;
+        Job* job = _take(self, &serialized);
+        if (job) {
+            job->run(job);
+            if (serialized) {
+                std::lock_guard<std::mutex> lk(_serialLock);
+                _serialBusy = false; /* Loop picks up the next serialized job */
+            }
+            continue;
+        }
+
+        /* Nothing found since 'seen': sleep until the next submit */
+        std::unique_lock<std::mutex> lk(_sleepLock);
+        _wake.wait(lk, [&] { return !_running || _generation != seen; });
+    }
+}
+
+#endif /* CLI_HOST_SERVER */
@@ -0,0 +1,112 @@
+/*************************************************************************
+ *                                                                       *
+ * https://github.com/hharte/ArduinoCLI                                  *
+ *                                                                       *
+ * Copyright (c) 2025 Howard M. Harte                                    *
+ *                                                                       *
+ * Module Description:                                                   *
+ * Host-only work-stealing thread pool for command handlers.             *
+ *                                                                       *
+ * Arduino 2.3.3 or later                                                *
+ *                                                                       *
+ *************************************************************************/
+
+/*!
+ * \file CLIWorkerPool.h
+ * \brief Defines the CLIWorkerPool class used by CLIHostServer to run handlers on worker threads.
+ */
+#ifndef CLIWorkerPool_h
+#define CLIWorkerPool_h
+
+#include "ArduinoCLI.h"
+
+#ifdef CLI_HOST_SERVER
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class CLIWorkerPool
+ * @brief Work-stealing pool of worker threads.
+ *
+ * Each worker owns a deque: it pops its own jobs from the back and steals from the front
+ * of the others when idle. Jobs marked as serialized go to one shared FIFO that at most one
+ * worker drains at a time, so they never run concurrently with each other.
+ */
+class CLIWorkerPool {
+public:
+    /**
+     * @brief Intrusive job; embed (or derive from) it in the object being processed.
+     */
+    struct Job {
+        void (*run)(Job* job);  /**< Called on a worker thread. */
+        bool serialized;        /**< Must not run concurrently with other serialized jobs. */
+    };
+
+    CLIWorkerPool();
+    ~CLIWorkerPool();
+
+    /**
+     * @brief Starts the worker threads.
+     * @param threads Number of workers (must be > 0).
+     * @return true on success.
+     */
+    bool begin(size_t threads);
+
+    /**
+     * @brief Stops and joins the workers. Jobs not yet started are dropped.
+     */
+    void end();
+
+    /**
+     * @brief Queues a job. Callable from any thread.
+     * @param job The job; must stay valid until its run() returns.
+     */
+    void submit(Job* job);
+
+    /**
+     * @brief Gets the number of worker threads.
+     * @return Worker count, 0 if not started.
+     */
+    size_t threads() const;
+
+private:
+    struct Worker {
+        std::mutex lock;            /**< Guards jobs. */
+        std::deque<Job*> jobs;      /**< Owner pops back, thieves pop front. */
+        std::thread thread;
+    };
+
+    Worker* _workers;               /**< Worker array. */
+    size_t _count;                  /**< Number of workers. */
+    std::atomic<size_t> _nextWorker; /**< Round-robin injection counter. */
+
+    std::mutex _serialLock;         /**< Guards _serialJobs and _serialBusy. */
+    std::deque<Job*> _serialJobs;   /**< Jobs that must run one at a time. */
+    bool _serialBusy;               /**< A serialized job is running. */
+
+    std::mutex _sleepLock;          /**< Guards _generation and _running. */
+    std::condition_variable _wake;  /**< Signalled when work may be available. */
+    unsigned long _generation;      /**< Bumped on every submit (event count). */
+    bool _running;                  /**< Workers keep running while true. */
+
+    /**
+     * @brief Worker thread body.
+     * @private
+     */
+    void _workerMain(size_t self);
+
+    /**
+     * @brief Takes a job: own deque, then steal, then the serialized FIFO.
+     * @param[out] serialized Set when the job came from the serialized FIFO.
+     * @private
+     */
+    Job* _take(size_t self, bool* serialized);
+};
+
+#endif /* CLI_HOST_SERVER */
+
+#endif /* CLIWorkerPool_h */